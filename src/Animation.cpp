@@ -13,83 +13,81 @@
 
 #include "Animation.h"
 
-Animation::Animation(std::string _name, Point _render_size, Point _render_offset, int _position, int _frames, int _duration, std::string _type)
-	: name(_name), sprites(NULL),
-	  render_size(_render_size), render_offset(_render_offset),
-	  position(_position), frames(_frames), duration(_duration), type(_type),
-	  cur_frame(0), disp_frame(0), mid_frame(0), max_frame(0), timesPlayed(0) {
+Animation::Animation()
+	: def(NULL), atlas(NULL),
+	  cur_frame(0), disp_frame(0), timesPlayed(0) {
+}
 
-	if (type == "play_once" || type == "looped") {
-		max_frame = frames * duration;
-	}
-	else if (type == "back_forth") {
-		mid_frame = frames * duration;
-		max_frame = mid_frame + mid_frame;
-	
-	}
+void Animation::play(const Animation_Def *_def) {
+	def = _def;
+	reset();
 }
 
 void Animation::advanceFrame() {
 
-	if (type == "play_once") {
-		if (cur_frame < max_frame - 1) {
+	switch (def->type) {
+	
+		case ANIM_PLAY_ONCE:
+			if (cur_frame < def->max_frame - 1) {
+				cur_frame++;
+			}
+			else {
+				timesPlayed = 1;
+			}
+			disp_frame = (cur_frame / def->duration) + def->position;
+			break;
+			
+		case ANIM_LOOPED:
 			cur_frame++;
-		}
-		else {
-			timesPlayed = 1;
-		}
-		disp_frame = (cur_frame / duration) + position;
-	}
-	else if (type == "looped") {
-		cur_frame++;
-		if (cur_frame == max_frame) {
-			cur_frame = 0;
-			//animation has completed one loop
-			timesPlayed++;
-		}
-		disp_frame = (cur_frame / duration) + position;	
-
-	}
-	else if (type == "back_forth") {
-		cur_frame++;
-				
-		if (cur_frame == max_frame) {
-			cur_frame = 0;
-			//animation has completed one loop
-			timesPlayed++;
-		}
-
-		if (cur_frame >= mid_frame) {
-			disp_frame = (max_frame -1 - cur_frame) / duration + position;
-		}
-		else {
-			disp_frame = cur_frame / duration + position;
-		}
+			if (cur_frame == def->max_frame) {
+				cur_frame = 0;
+				//animation has completed one loop
+				timesPlayed++;
+			}
+			disp_frame = (cur_frame / def->duration) + def->position;	
+			break;
+			
+		case ANIM_BACK_FORTH:
+			cur_frame++;
+					
+			if (cur_frame == def->max_frame) {
+				cur_frame = 0;
+				//animation has completed one loop
+				timesPlayed++;
+			}
 
+			if (cur_frame >= def->mid_frame) {
+				disp_frame = (def->max_frame -1 - cur_frame) / def->duration + def->position;
+			}
+			else {
+				disp_frame = cur_frame / def->duration + def->position;
+			}
+			break;
 	}
 }
 
 Renderable Animation::getCurrentFrame(int direction) {
 	Renderable r;
+	r.sprite = NULL;
 
-	// if the animation contains the spritesheet
-	if (sprites != NULL) {
-		r.sprite = sprites;
-	}
-
-	r.src.x = render_size.x * disp_frame;
-	r.src.y = render_size.y * direction;
-	r.src.w = render_size.x;
-	r.src.h = render_size.y;
-	r.offset.x = render_offset.x;
-	r.offset.y = render_offset.y; // 112
+	r.src.x = def->render_size.x * disp_frame;
+	r.src.y = def->render_size.y * direction;
+	r.src.w = def->render_size.x;
+	r.src.h = def->render_size.y;
+	r.offset.x = def->render_offset.x;
+	r.offset.y = def->render_offset.y; // 112
 	r.object_layer = true;
+
+	// if the animation has a packed spritesheet, point into it
+	if (atlas != NULL) {
+		atlas->apply(r);
+	}
 	return r;
 }
 
 void Animation::reset() {
 	cur_frame = 0;
-	disp_frame = (cur_frame / duration) + position;
+	disp_frame = (cur_frame / def->duration) + def->position;
 	timesPlayed = 0;
 }
 
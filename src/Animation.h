@@ -7,6 +7,9 @@
  * The intention with the class is to keep it as flexible as possible so that the animations
  * can be used not only for character animations but any animated in-game objects.
  *
+ * The frame tables (Animation_Def) are shared through AnimationSet; an
+ * Animation only holds one entity's place in the animation it is playing.
+ *
  * @author kitano
  * @license GPL
  */
@@ -16,35 +19,50 @@
 
 #include "SDL_image.h"
 #include "Utils.h"
+#include "SpriteAtlas.h"
+#include "Atom.h"
 #include <string>
 
-class Animation {
-
-protected:
-	std::string name;
+// animation types
+const int ANIM_NONE = 0; // unknown type, stays on its first frame
+const int ANIM_PLAY_ONCE = 1;
+const int ANIM_LOOPED = 2;
+const int ANIM_BACK_FORTH = 3;
 
-	// The sprite sheet
-	SDL_Surface* sprites;
+struct Animation_Def {
+	int name; // atom
 
 	// The type of animation: eg. play_once or looped
-	std::string type;
+	int type;
 	
 	// Animation data
-	int frameSize;
 	int position;
 	int frames;
 	int duration;
-	int cur_frame;
-	int disp_frame;
 	int mid_frame;
 	int max_frame;
 	Point render_size;
 	Point render_offset;
+};
+
+class Animation {
+
+protected:
+	const Animation_Def *def;
+
+	// The packed sprite sheet, if any
+	SpriteAtlas *atlas;
 
+	int cur_frame;
+	int disp_frame;
 	int timesPlayed;
 
 public:
-	Animation(std::string, Point _render_size, Point _render_offset, int position, int frames, int duration, std::string);
+	Animation();
+
+	// start playing _def from its first frame
+	void play(const Animation_Def *_def);
+	const Animation_Def *getDef() { return def; }
 
 	// advance the animation one frame
 	void advanceFrame();
@@ -52,7 +70,7 @@ public:
 	Renderable getCurrentFrame(int direction);
 
 	int getCurFrame() { return cur_frame; }
-	int getMaxFrame() { return max_frame; }
+	int getMaxFrame() { return def->max_frame; }
 	// in a looped animation returns how many times it's been played
 	// in a play once animation returns 1 when the animation is finished
 	int getTimesPlayed() { return timesPlayed; }
@@ -60,7 +78,11 @@ public:
 	// resets to beginning of the animation
 	void reset();
 
-	std::string getName() { return name; }
+	int getName() { return def->name; }
+	Point getRenderSize() { return def->render_size; }
+
+	// frames are looked up in this atlas when rendering
+	void setAtlas(SpriteAtlas *_atlas) { atlas = _atlas; }
 };
 
 #endif
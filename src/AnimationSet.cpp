@@ -0,0 +1,156 @@
+/**
+ * class AnimationSet
+ *
+ * @author agent
+ * @author kitano
+ * @license GPL
+ */
+
+#include "AnimationSet.h"
+
+map< pair<string, int>, AnimationSet* > AnimationSet::cache;
+
+/**
+ * The shared set for this file at this animation speed, loaded on first use.
+ * Sets live until clearCache() at shutdown.
+ */
+AnimationSet *AnimationSet::get(string filename, int animation_speed) {
+	pair<string, int> key(filename, animation_speed);
+	map< pair<string, int>, AnimationSet* >::iterator it = cache.find(key);
+	if (it != cache.end()) return it->second;
+	
+	AnimationSet *set = new AnimationSet(filename, animation_speed);
+	cache[key] = set;
+	return set;
+}
+
+/**
+ * Free every shared set.  No entity may use one afterwards.
+ */
+void AnimationSet::clearCache() {
+	map< pair<string, int>, AnimationSet* >::iterator it;
+	for (it = cache.begin(); it != cache.end(); ++it) {
+		delete it->second;
+	}
+	cache.clear();
+}
+
+/**
+ * Load the animation definition file
+ */
+AnimationSet::AnimationSet(string filename, int animation_speed) {
+
+	FileParser parser;
+
+	if (!parser.open(filename)) {
+		cout << "Error loading animation definition file: " << filename << endl;
+		exit(1);
+	}
+
+	Animation_Def def;
+	def.name = ATOM_NONE;
+	def.type = ANIM_NONE;
+	def.position = 0;
+	def.frames = 0;
+	def.duration = 0;
+	def.mid_frame = 0;
+	def.max_frame = 0;
+	def.render_size.x = def.render_size.y = 0;
+	def.render_offset.x = def.render_offset.y = 0;
+	first = ATOM_NONE;
+
+	// Parse the file and on each new section create an animation from the data parsed previously
+	// (values carry over from one section to the next)
+
+	parser.next();
+	parser.new_section = false; // do not create the first animation until parser has parsed first section
+
+	do {
+		// create the animation if finished parsing a section
+		if (parser.new_section) {
+			defs.push_back(def);
+		}
+
+		if (parser.key == "position") {
+			if (isInt(parser.val)) {
+				def.position = atoi(parser.val.c_str());
+			}
+		}	
+		else if (parser.key == "frames") {
+			if (isInt(parser.val)) {
+				def.frames = atoi(parser.val.c_str());
+			}
+		}	
+		else if (parser.key == "duration") {
+			if (isInt(parser.val)) {
+				int ms_per_frame = atoi(parser.val.c_str());
+				
+				def.duration = round((float)ms_per_frame / (1000.0 / (float)FRAMES_PER_SEC));
+
+				// adjust duration according to the entity's animation speed
+				def.duration = (def.duration * 100) / animation_speed;
+				
+				// TEMP: if an animation is too fast, display one frame per fps anyway
+				if (def.duration < 1) def.duration=1;
+			}
+		}	
+		else if (parser.key == "type") {
+			if (parser.val == "play_once") def.type = ANIM_PLAY_ONCE;
+			else if (parser.val == "looped") def.type = ANIM_LOOPED;
+			else if (parser.val == "back_forth") def.type = ANIM_BACK_FORTH;
+			else def.type = ANIM_NONE;
+		}
+		else if (parser.key == "render_size_x") {
+			if (isInt(parser.val)) {
+				def.render_size.x = atoi(parser.val.c_str());
+			}
+		}	
+		else if (parser.key == "render_size_y") {
+			if (isInt(parser.val)) {
+				def.render_size.y = atoi(parser.val.c_str());
+			}
+		}	
+		else if (parser.key == "render_offset_x") {
+			if (isInt(parser.val)) {
+				def.render_offset.x = atoi(parser.val.c_str());
+			}
+		}	
+		else if (parser.key == "render_offset_y") {
+			if (isInt(parser.val)) {
+				def.render_offset.y = atoi(parser.val.c_str());
+			}
+		}	
+
+		if (def.name == ATOM_NONE) {
+			// This is the first animation
+			first = atom(parser.section);
+		}
+		def.name = atom(parser.section);
+	}
+	while (parser.next());
+
+	// add final animation
+	defs.push_back(def);
+
+	// frame counts only depend on the finished definition
+	for (unsigned i=0; i<defs.size(); i++) {
+		Animation_Def &d = defs[i];
+		if (d.type == ANIM_PLAY_ONCE || d.type == ANIM_LOOPED) {
+			d.max_frame = d.frames * d.duration;
+		}
+		else if (d.type == ANIM_BACK_FORTH) {
+			d.mid_frame = d.frames * d.duration;
+			d.max_frame = d.mid_frame + d.mid_frame;
+		}
+		else {
+			d.mid_frame = d.max_frame = 0;
+		}
+	}
+}
+
+int AnimationSet::find(int name) {
+	for (unsigned i=0; i<defs.size(); i++) {
+		if (defs[i].name == name) return i;
+	}
+	return -1;
+}
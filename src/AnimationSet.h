@@ -0,0 +1,46 @@
+/**
+ * class AnimationSet
+ *
+ * The frame tables of one animation definition file.
+ *
+ * Sets are parsed once per file and animation speed and then shared by every
+ * entity using them; they never change after loading.  Each entity only
+ * keeps its own Animation playback state.
+ *
+ * @author agent
+ * @author kitano
+ * @license GPL
+ */
+
+#ifndef ANIMATION_SET_H
+#define ANIMATION_SET_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "Animation.h"
+#include "FileParser.h"
+#include "UtilsParsing.h"
+#include "Settings.h"
+
+using namespace std;
+
+class AnimationSet {
+private:
+	static map< pair<string, int>, AnimationSet* > cache;
+
+	AnimationSet(string filename, int animation_speed);
+
+public:
+	static AnimationSet *get(string filename, int animation_speed);
+	static void clearCache();
+
+	// index of the animation whose name is this atom, or -1
+	int find(int name);
+
+	vector<Animation_Def> defs;
+	int first; // name of the default animation, ATOM_NONE if there is none
+};
+
+#endif
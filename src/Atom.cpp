@@ -0,0 +1,49 @@
+/**
+ * Atoms
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "Atom.h"
+#include <map>
+#include <vector>
+
+// names of the fixed atoms, in enum order
+static const char *FIXED_NAMES[ATOM_FIXED_COUNT] = {
+	"",
+	"stance", "run", "block", "hit", "die", "critdie", "melee", "ranged", "ment",
+	"run_once", "requires_status", "requires_not", "requires_item", "set_status", "unset_status",
+	"intermap", "mapmod", "soundfx", "loot", "msg", "shakycam", "remove_item",
+	"reward_xp", "reward_currency", "reward_item", "him", "her", "you", "quest_text"
+};
+
+static map<string, int> atom_ids;
+static vector<string> atom_names;
+
+static void initAtoms() {
+	for (int i=0; i<ATOM_FIXED_COUNT; i++) {
+		atom_ids[FIXED_NAMES[i]] = i;
+		atom_names.push_back(FIXED_NAMES[i]);
+	}
+}
+
+/**
+ * The atom for name, creating it if needed
+ */
+int atom(const string &name) {
+	if (atom_names.empty()) initAtoms();
+
+	map<string, int>::iterator it = atom_ids.find(name);
+	if (it != atom_ids.end()) return it->second;
+
+	int id = atom_names.size();
+	atom_ids[name] = id;
+	atom_names.push_back(name);
+	return id;
+}
+
+const string &atomName(int id) {
+	if (atom_names.empty()) initAtoms();
+	return atom_names[id];
+}
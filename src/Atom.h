@@ -0,0 +1,66 @@
+/**
+ * Atoms
+ *
+ * Identifiers read from data files (animation names, event types) are
+ * interned into small integers when loaded, so per-frame code compares ints
+ * instead of strings.
+ *
+ * Names the engine tests for have fixed atoms below; any other name gets the
+ * next free atom the first time it is interned.  The same name always maps to
+ * the same atom for the rest of the run.  Atoms are only created while loading,
+ * on the main thread; reading them is safe from anywhere.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef ATOM_H
+#define ATOM_H
+
+#include <string>
+
+using namespace std;
+
+enum {
+	ATOM_NONE = 0, // the empty string
+
+	// animations
+	ATOM_STANCE,
+	ATOM_RUN,
+	ATOM_BLOCK,
+	ATOM_HIT,
+	ATOM_DIE,
+	ATOM_CRITDIE,
+	ATOM_MELEE,
+	ATOM_RANGED,
+	ATOM_MENT,
+
+	// event types and components
+	ATOM_RUN_ONCE,
+	ATOM_REQUIRES_STATUS,
+	ATOM_REQUIRES_NOT,
+	ATOM_REQUIRES_ITEM,
+	ATOM_SET_STATUS,
+	ATOM_UNSET_STATUS,
+	ATOM_INTERMAP,
+	ATOM_MAPMOD,
+	ATOM_SOUNDFX,
+	ATOM_LOOT,
+	ATOM_MSG,
+	ATOM_SHAKYCAM,
+	ATOM_REMOVE_ITEM,
+	ATOM_REWARD_XP,
+	ATOM_REWARD_CURRENCY,
+	ATOM_REWARD_ITEM,
+	ATOM_HIM,
+	ATOM_HER,
+	ATOM_YOU,
+	ATOM_QUEST_TEXT,
+
+	ATOM_FIXED_COUNT
+};
+
+int atom(const string &name);
+const string &atomName(int id);
+
+#endif
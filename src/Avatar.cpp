@@ -36,6 +36,8 @@ void Avatar::init() {
 	lockSwing = false;
 	lockCast = false;
 	lockShoot = false;
+	drag_walking = false;
+	move_to_target = false;
 	
 	stats.name = "Unknown";
 	stats.hero = true;
@@ -124,9 +126,17 @@ void Avatar::loadGraphics(string _img_main, string _img_armor, string _img_off)
 		if (gfx_head) SDL_FreeSurface(gfx_head);
 		
 		// optimize
-		SDL_Surface *cleanup = sprites;
-		sprites = SDL_DisplayFormatAlpha(sprites);
-		SDL_FreeSurface(cleanup);
+		sprites = optimizeSurface(sprites);
+		
+		// pack the composite; the full sheet is only kept if packing fails
+		if (atlas.build(sprites, getRenderSize())) {
+			SDL_FreeSurface(sprites);
+			sprites = NULL;
+			setAtlas(&atlas);
+		}
+		else {
+			setAtlas(NULL);
+		}
 	}
 }
 
@@ -150,16 +160,62 @@ void Avatar::loadSounds() {
 
 bool Avatar::pressing_move() {
 	if(MOUSE_MOVE) {
-		return inp->pressing[MAIN1];
+		// keep walking to the clicked spot after the button is released
+		if (!move_to_target) return false;
+		return abs(move_target.x - stats.pos.x) > stats.speed || abs(move_target.y - stats.pos.y) > stats.speed;
 	} else {
 		return inp->pressing[UP] || inp->pressing[DOWN] || inp->pressing[LEFT] || inp->pressing[RIGHT];
 	}	
 }
 
+/**
+ * Line of sight from the hero, read from the shared field of view when it reaches the target
+ */
+bool Avatar::canSee(Point target) {
+	bool visible;
+	if (map->fov.lookup(stats.pos, target, visible)) return visible;
+	return map->collider.line_of_sight(stats.pos.x, stats.pos.y, target.x, target.y);
+}
+
+/**
+ * Set the click-to-move target under the cursor.
+ * A click always aims it.  While the button stays held it follows the cursor,
+ * but only when the mouse itself moves onto another tile: the view scrolls
+ * with the hero, so the map point under a still cursor keeps changing.
+ *
+ * @param click True for a new click on the ground
+ */
+void Avatar::aimMove(bool click) {
+	if (!click) {
+		if (!move_to_target || !drag_walking || !inp->pressing[MAIN1]) return;
+		if (inp->mouse.x == move_mouse.x && inp->mouse.y == move_mouse.y) return;
+	}
+	
+	Point target = screen_to_map(inp->mouse.x,  inp->mouse.y, stats.pos.x, stats.pos.y);
+	move_mouse = inp->mouse;
+	if (click || (target.x >> TILE_SHIFT) != (move_target.x >> TILE_SHIFT) || (target.y >> TILE_SHIFT) != (move_target.y >> TILE_SHIFT)) {
+		move_target = target;
+	}
+	move_to_target = true;
+}
+
 void Avatar::set_direction() {
 	// handle direction changes
 	if(MOUSE_MOVE) {
-		Point target = screen_to_map(inp->mouse.x,  inp->mouse.y, stats.pos.x, stats.pos.y);
+		if (!move_to_target) {
+			Point target = screen_to_map(inp->mouse.x,  inp->mouse.y, stats.pos.x, stats.pos.y);
+			stats.direction = face(target.x, target.y);
+			return;
+		}
+		
+		aimMove(false);
+		Point target = move_target;
+		
+		// walk around obstacles between the hero and the target
+		Point step;
+		if (!map->collider.line_of_movement(stats.pos.x, stats.pos.y, target.x, target.y) && map->planner.nextStep(stats.pos, target, step)) {
+			target = step;
+		}
 		stats.direction = face(target.x, target.y);
 	} else {
 		if(inp->pressing[UP] && inp->pressing[LEFT]) stats.direction = 1;
@@ -219,7 +275,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 	switch(stats.cur_state) {
 		case AVATAR_STANCE:
 
-			setAnimation("stance");
+			setAnimation(ATOM_STANCE);
 		
 			// allowed to move or use powers?
 			if (MOUSE_MOVE) {
@@ -232,8 +288,10 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			}
 
 			// handle transitions to RUN
-			if (allowed_to_move)
+			if (allowed_to_move) {
+				if (MOUSE_MOVE && inp->pressing[MAIN1] && !drag_walking) aimMove(true);
 				set_direction();
+			}
 			
 			if (pressing_move() && allowed_to_move) {
 				if (MOUSE_MOVE && inp->pressing[MAIN1]) {
@@ -259,7 +317,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 					break;
 				if (powers->powers[actionbar_power].requires_offense_weapon && !stats.wielding_offense)
 					break;
-				if (powers->powers[actionbar_power].requires_los && !map->collider.line_of_sight(stats.pos.x, stats.pos.y, target.x, target.y))
+				if (powers->powers[actionbar_power].requires_los && !canSee(target))
 					break;
 				if (powers->powers[actionbar_power].requires_empty_target && !map->collider.is_empty(target.x, target.y))
 					break;
@@ -299,7 +357,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			
 		case AVATAR_RUN:
 
-			setAnimation("run");
+			setAnimation(ATOM_RUN);
 		
 			stepfx = rand() % 4;
 			
@@ -315,6 +373,13 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 				allowed_to_use_power = true;
 			}
 			
+			// a new click on the ground picks a new target
+			if (MOUSE_MOVE && restrictPowerUse && inp->pressing[MAIN1] && !inp->lock[MAIN1]) {
+				inp->lock[MAIN1] = true;
+				drag_walking = true;
+				aimMove(true);
+			}
+			
 			// handle direction changes
 			set_direction();
 			
@@ -342,7 +407,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 					break;
 				if (powers->powers[actionbar_power].requires_offense_weapon && !stats.wielding_offense)
 					break;
-				if (powers->powers[actionbar_power].requires_los && !map->collider.line_of_sight(stats.pos.x, stats.pos.y, target.x, target.y))
+				if (powers->powers[actionbar_power].requires_los && !canSee(target))
 					break;
 				if (powers->powers[actionbar_power].requires_empty_target && !map->collider.is_empty(target.x, target.y))
 					break;
@@ -382,7 +447,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			
 		case AVATAR_MELEE:
 
-			setAnimation("melee");
+			setAnimation(ATOM_MELEE);
 
 			if (activeAnimation->getCurFrame() == 1) {
 				Mix_PlayChannel(-1, sound_melee, 0);
@@ -401,7 +466,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 
 		case AVATAR_CAST:
 
-			setAnimation("ment");
+			setAnimation(ATOM_MENT);
 
 			// do power
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()/2) {
@@ -417,7 +482,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			
 		case AVATAR_SHOOT:
 		
-			setAnimation("ranged");
+			setAnimation(ATOM_RANGED);
 
 			// do power
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()/2) {
@@ -432,7 +497,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 
 		case AVATAR_BLOCK:
 		
-			setAnimation("block");
+			setAnimation(ATOM_BLOCK);
 
 			if (powers->powers[actionbar_power].new_state != POWSTATE_BLOCK) {
 				stats.cur_state = AVATAR_STANCE;
@@ -442,7 +507,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			
 		case AVATAR_HIT:
 
-			setAnimation("hit");
+			setAnimation(ATOM_HIT);
 						 
 			if (activeAnimation->getTimesPlayed() >= 1) {
 				stats.cur_state = AVATAR_STANCE;
@@ -452,7 +517,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			
 		case AVATAR_DEAD:
 
-			setAnimation("die");
+			setAnimation(ATOM_DIE);
 				
 			if (activeAnimation->getCurFrame() == 1 && activeAnimation->getTimesPlayed() < 1) {
 				Mix_PlayChannel(-1, sound_die, 0);
@@ -487,6 +552,12 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
 			break;
 	}
 	
+	// the walk ends on arrival, on a wall, or when a power interrupts it;
+	// a held button keeps the target for the drag
+	if (stats.cur_state != AVATAR_RUN && (stats.cur_state != AVATAR_STANCE || !drag_walking)) {
+		move_to_target = false;
+	}
+	
 	// calc new cam position from player position
 	// cam is focused at player position
 	map->cam.x = stats.pos.x;
@@ -502,7 +573,7 @@ void Avatar::logic(int actionbar_power, bool restrictPowerUse) {
  * Called by HazardManager
  * Return false on a miss
  */
-bool Avatar::takeHit(Hazard h) {
+bool Avatar::takeHit(const Hazard &h) {
 
 	if (stats.cur_state != AVATAR_DEAD) {
 	
@@ -600,7 +671,7 @@ bool Avatar::takeHit(Hazard h) {
  */
 Renderable Avatar::getRender() {
 	Renderable r = activeAnimation->getCurrentFrame(stats.direction);
-	r.sprite = sprites;
+	if (r.sprite == NULL) r.sprite = sprites;
 	r.map_pos.x = stats.pos.x;
 	r.map_pos.y = stats.pos.y;
 	return r;
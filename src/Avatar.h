@@ -55,6 +55,12 @@ private:
 	string img_armor;
 	string img_off;
 
+	// trimmed copy of the composited hero sheet
+	SpriteAtlas atlas;
+
+	// cursor position when move_target was last aimed, in screen pixels
+	Point move_mouse;
+
 public:
 	Avatar(PowerManager *_powers, InputState *_inp, MapIso *_map);
 	~Avatar();
@@ -65,8 +71,10 @@ public:
 	
 	void logic(int actionbar_power, bool restrictPowerUse);
 	bool pressing_move();	
+	void aimMove(bool click);
 	void set_direction();
-	bool takeHit(Hazard h);
+	bool canSee(Point target);
+	bool takeHit(const Hazard &h);
 	string log_msg;
 
 	virtual Renderable getRender();
@@ -76,6 +84,10 @@ public:
 	int current_power;
 	Point act_target;
 	bool drag_walking;
+	
+	// click-to-move: where the hero is walking to with MOUSE_MOVE
+	bool move_to_target;
+	Point move_target;
 };
 
 #endif
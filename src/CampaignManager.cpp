@@ -28,82 +28,90 @@ CampaignManager::CampaignManager() {
 
 void CampaignManager::clearAll() {
 	// clear campaign data
-	for (int i=0; i<MAX_STATUS; i++) {
-		status[i] = "";
-	}
-	status_count = 0;
+	status_bits.clear();
+	status_order.clear();
+	status_changed.clear();
+	quest_update = true;
 }
 
 /**
- * Take the savefile campaign= and convert to status array
+ * Take the savefile campaign= and set each status
  */
 void CampaignManager::setAll(std::string s) {
 	string str = s + ',';
 	string token;
-	while (str != "" && status_count < MAX_STATUS) {
+	while (str != "") {
 		token = eatFirstString(str, ',');
-		if (token != "") status[status_count++] = token;
+		if (token != "") setStatus(atom(token));
 	}
 	quest_update = true;
 }
 
 /**
- * Convert status array to savefile campaign= (status csv)
+ * Convert set statuses to savefile campaign= (status csv)
  */
 std::string CampaignManager::getAll() {
 	stringstream ss;
 	ss.str("");
-	for (int i=0; i<status_count; i++) {
-		ss << status[i];
-		if (i < status_count-1) ss << ',';
+	for (unsigned i=0; i<status_order.size(); i++) {
+		ss << atomName(status_order[i]);
+		if (i < status_order.size()-1) ss << ',';
 	}
 	return ss.str();
 }
 
 bool CampaignManager::checkStatus(std::string s) {
 
-	// avoid searching empty statuses
+	// avoid interning empty statuses
 	if (s == "") return false;
-	
-	for (int i=0; i<status_count; i++) {
-		if (status[i] == s) return true;
-	}
-	return false;
+	return checkStatus(atom(s));
 }
 
 void CampaignManager::setStatus(std::string s) {
+	if (s == "") return;
+	setStatus(atom(s));
+}
 
-	// avoid adding empty statuses
+void CampaignManager::unsetStatus(std::string s) {
 	if (s == "") return;
+	unsetStatus(atom(s));
+}
+
+bool CampaignManager::checkStatus(int id) {
+	unsigned word = id >> 5;
+	if (id == ATOM_NONE || word >= status_bits.size()) return false;
+	return (status_bits[word] & (1u << (id & 31))) != 0;
+}
+
+void CampaignManager::setStatus(int id) {
+
+	// avoid adding empty statuses
+	if (id == ATOM_NONE) return;
 
-	// hit upper limit for status
-	// TODO: add a warning
-	if (status_count >= MAX_STATUS) return;
-	
 	// if it's already set, don't add it again
-	if (checkStatus(s)) return;
+	if (checkStatus(id)) return;
 	
-	status[status_count++] = s;
-	quest_update = true;
+	unsigned word = id >> 5;
+	if (word >= status_bits.size()) status_bits.resize(word+1, 0);
+	status_bits[word] |= 1u << (id & 31);
+	status_order.push_back(id);
+	status_changed.push_back(id);
 }
 
-void CampaignManager::unsetStatus(std::string s) {
+void CampaignManager::unsetStatus(int id) {
 
-	// avoid searching empty statuses
-	if (s == "") return;
-
-	for (int i=status_count-1; i>=0; i--) {
-		if (status[i] == s) {
-		
-			// bubble existing statuses down
-			for (int j=i; j<status_count-1; j++) {
-				status[j] = status[j+1];
-			}
-			status_count--;
-			quest_update = true;
-			return;
+	if (!checkStatus(id)) return;
+	
+	status_bits[id >> 5] &= ~(1u << (id & 31));
+	
+	// keep the remaining statuses in order
+	for (int i=status_order.size()-1; i>=0; i--) {
+		if (status_order[i] == id) {
+			status_order.erase(status_order.begin() + i);
+			break;
 		}
 	}
+	status_changed.push_back(id);
 }
 
 bool CampaignManager::checkItem(int item_id) {
@@ -12,15 +12,20 @@
 
 #include <string>
 #include <sstream>
+#include <vector>
+#include "Atom.h"
 #include "UtilsParsing.h"
 #include "MenuItemStorage.h"
 #include "ItemDatabase.h"
 
-const int MAX_STATUS = 1024;
-
 class CampaignManager {
 private:
 
+	// statuses are atoms; one bit per atom says whether it is set,
+	// and status_order keeps the set ones in the order they were set for the save file
+	vector<Uint32> status_bits;
+	vector<int> status_order;
+
 public:
 	CampaignManager();
 	~CampaignManager();
@@ -31,6 +36,9 @@ public:
 	bool checkStatus(std::string s);
 	void setStatus(std::string s);
 	void unsetStatus(std::string s);
+	bool checkStatus(int id);
+	void setStatus(int id);
+	void unsetStatus(int id);
 	bool checkItem(int item_id);
 	void removeItem(int item_id);
 	void rewardItem(ItemStack istack);
@@ -38,8 +46,6 @@ public:
 	void rewardXP(int amount);
 	void addMsg(string msg);
 	
-	string status[MAX_STATUS];
-	int status_count;
 	string log_msg;
 	ItemStack drop_stack;
 	
@@ -49,7 +55,10 @@ public:
 	int *currency;
 	int *xp;
 	
+	// the quest log rebuilds everything when quest_update is set,
+	// otherwise only the quests that depend on a changed status
 	bool quest_update;
+	vector<int> status_changed;
 };
 
 
@@ -20,6 +20,9 @@ Enemy::Enemy(PowerManager *_powers, MapIso *_map) : Entity(_map) {
 	stats.in_combat = false;
 	
 	haz = NULL;
+	path_goal.x = -1;
+	path_goal.y = -1;
+	rng = 1;
 	
 	sfx_phys = false;
 	sfx_ment = false;
@@ -28,38 +31,96 @@ Enemy::Enemy(PowerManager *_powers, MapIso *_map) : Entity(_map) {
 	sfx_critdie = false;
 	loot_drop = false;
 	reward_xp = false;
+	
+	columns = NULL;
+	index = -1;
+}
+
+/**
+ * Move this enemy's per-frame state into its row of the columns.
+ * From here on the columns are the only live copy.
+ */
+void Enemy::bind(Enemy_Columns *_columns, int _index) {
+	columns = _columns;
+	index = _index;
+	pos() = stats.pos;
+	direction() = stats.direction;
+	curState() = stats.cur_state;
+	hp() = stats.hp;
+	cooldownTicks() = stats.cooldown_ticks;
+	dirTicks() = stats.dir_ticks;
+	patrolTicks() = stats.patrol_ticks;
+	threatRange() = stats.threat_range;
+	inCombat() = stats.in_combat;
+	corpse() = stats.corpse;
+}
+
+/**
+ * Bring the StatBlock up to date before handing it to code shared with
+ * the hero (powers, hazards).  That code reads position, direction and hp,
+ * and may change hp; returnStats() takes the change back.
+ */
+void Enemy::lendStats() {
+	stats.pos = pos();
+	stats.direction = direction();
+	stats.hp = hp();
+}
+
+void Enemy::returnStats() {
+	hp() = stats.hp;
+}
+
+bool Enemy::move() {
+	return Entity::move(pos(), direction());
+}
+
+int Enemy::face(int mapx, int mapy) {
+	return Entity::face(pos(), direction(), mapx, mapy);
+}
+
+void Enemy_Columns::resize(int count) {
+	pos.resize(count);
+	direction.resize(count);
+	state.resize(count);
+	hp.resize(count);
+	cooldown_ticks.resize(count);
+	dir_ticks.resize(count);
+	patrol_ticks.resize(count);
+	threat_range.resize(count);
+	in_combat.resize(count);
+	corpse.resize(count);
 }
 
 /**
  * The current direction leads to a wall.  Try the next best direction, if one is available.
  */
 int Enemy::faceNextBest(int mapx, int mapy) {
-	int dx = abs(mapx - stats.pos.x);
-	int dy = abs(mapy - stats.pos.y);
-	switch (stats.direction) {
+	int dx = abs(mapx - pos().x);
+	int dy = abs(mapy - pos().y);
+	switch (direction()) {
 		case 0:
 			if (dy > dx) return 7;
 			else return 1;
 		case 1:
-			if (mapy > stats.pos.y) return 0;
+			if (mapy > pos().y) return 0;
 			else return 2;
 		case 2:
 			if (dx > dy) return 1;
 			else return 3;
 		case 3:
-			if (mapx < stats.pos.x) return 2;
+			if (mapx < pos().x) return 2;
 			else return 4;
 		case 4:
 			if (dy > dx) return 3;
 			else return 5;
 		case 5:
-			if (mapy < stats.pos.y) return 4;
+			if (mapy < pos().y) return 4;
 			else return 6;
 		case 6:
 			if (dx > dy) return 5;
 			else return 7;
 		case 7:
-			if (mapx > stats.pos.x) return 6;
+			if (mapx > pos().x) return 6;
 			else return 0;
 	}
 	return 0;
@@ -69,16 +130,100 @@ int Enemy::faceNextBest(int mapx, int mapy) {
  * Calculate distance between the enemy and the hero
  */
 int Enemy::getDistance(Point dest) {
-	int dx = dest.x - stats.pos.x;
-	int dy = dest.y - stats.pos.y;
+	int dx = dest.x - pos().x;
+	int dy = dest.y - pos().y;
 	double step1 = (double)dx * (double)dx + (double)dy * (double)dy;
 	double step2 = sqrt(step1);
 	return int(step2);
 }
 
+void Enemy::seedRandom(Uint32 seed) {
+	rng = seed ? seed : 1;
+}
+
+/**
+ * 0-99 from this enemy's xorshift stream
+ */
+int Enemy::percentRoll() {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return (int)(rng % 100);
+}
+
+void Enemy::queue(int type, int power, Point target) {
+	Enemy_Command c;
+	c.type = type;
+	c.power = power;
+	c.target = target;
+	commands.push_back(c);
+}
+
+/**
+ * Apply the side effects queued by logic(), in the order they were queued.
+ * Called by EnemyManager one enemy at a time.
+ */
+void Enemy::commit() {
+	for (unsigned i=0; i<commands.size(); i++) {
+		Enemy_Command &c = commands[i];
+		switch (c.type) {
+			case ENEMY_CMD_POWER:
+				lendStats();
+				powers->activate(c.power, &stats, c.target);
+				returnStats();
+				break;
+			case ENEMY_CMD_REWARDS:
+				doRewards();
+				break;
+			case ENEMY_CMD_PATH:
+				if (map->pathfinder.findPath(pos(), c.target, path))
+					path_goal = c.target;
+				else
+					path.clear();
+				break;
+		}
+	}
+	commands.clear();
+}
+
+/**
+ * Steer towards target, going around walls when the direct line is blocked.
+ * Targets in the hero's tile use the shared flow field.
+ * Paths are kept until the target moves.  A new path is asked for through
+ * commit(); until it arrives (or if the path finder has no time left this
+ * frame) steer straight at the target.
+ *
+ * @return The point to head for this frame
+ */
+Point Enemy::followPath(Point target) {
+	Point step;
+	if (map->flowfield.nextStep(pos(), target, step)) {
+		path.clear();
+		return step;
+	}
+
+	if (map->collider.line_clear(pos().x, pos().y, target.x, target.y, CHECK_MOVEMENT)) {
+		path.clear();
+		return target;
+	}
+
+	if (path.empty() || path_goal.x != target.x || path_goal.y != target.y) {
+		path.clear();
+		queue(ENEMY_CMD_PATH, 0, target);
+		return target;
+	}
+
+	// drop waypoints we have reached
+	while (!path.empty() && getDistance(path.front()) <= stats.speed) {
+		path.erase(path.begin());
+	}
+	if (path.empty()) return target;
+	return path.front();
+}
+
 void Enemy::newState(int state) {
 	
-	stats.cur_state = state;
+	curState() = state;
 }
 	
 /**
@@ -86,24 +231,28 @@ void Enemy::newState(int state) {
  * Handle a single frame.  This includes:
  * - move the enemy based on AI % chances
  * - calculate the next frame of animation
+ *
+ * EnemyManager may run many enemies' logic() at once on several threads,
+ * so only this enemy may be changed here.  Anything touching shared state
+ * goes through queue() and happens in commit().
  */
 void Enemy::logic() {
 
-	stats.logic();
+	stats.logic(hp(), cooldownTicks());
 	if (stats.stun_duration > 0) return;
 	// check for bleeding to death
-	if (stats.hp <= 0 && !(stats.cur_state == ENEMY_DEAD || stats.cur_state == ENEMY_CRITDEAD)) {
-		doRewards();
-		stats.cur_state = ENEMY_DEAD;
+	if (hp() <= 0 && !(curState() == ENEMY_DEAD || curState() == ENEMY_CRITDEAD)) {
+		queue(ENEMY_CMD_REWARDS, 0, pos());
+		curState() = ENEMY_DEAD;
 	}
 	// check for bleeding spurt
 	if (stats.bleed_duration % 30 == 1) {
-		powers->activate(POWER_SPARK_BLOOD, &stats, stats.pos);
+		queue(ENEMY_CMD_POWER, POWER_SPARK_BLOOD, pos());
 	}
 	// check for teleport powers
 	if (stats.teleportation) {
-		stats.pos.x = stats.teleport_destination.x;
-		stats.pos.y = stats.teleport_destination.y;	
+		pos().x = stats.teleport_destination.x;
+		pos().y = stats.teleport_destination.y;	
 		stats.teleportation = false;	
 	}
 	
@@ -125,30 +274,32 @@ void Enemy::logic() {
 		dist = 0;
 	
 	// if the hero is too far away or dead, abandon combat and do nothing
-	if (dist > stats.threat_range+stats.threat_range || !stats.hero_alive) {
-		stats.in_combat = false;
-		stats.patrol_ticks = 0;
+	if (dist > threatRange()+threatRange() || !stats.hero_alive) {
+		inCombat() = false;
+		patrolTicks() = 0;
 		stats.last_seen.x = -1;
 		stats.last_seen.y = -1;
 	}
 
-	if (dist < stats.threat_range && stats.hero_alive)
-		los = map->collider.line_of_sight(stats.pos.x, stats.pos.y, stats.hero_pos.x, stats.hero_pos.y);
+	if (dist < threatRange() && stats.hero_alive) {
+		if (!map->fov.lookup(stats.hero_pos, pos(), los))
+			los = map->collider.line_clear(pos().x, pos().y, stats.hero_pos.x, stats.hero_pos.y, CHECK_SIGHT);
+	}
 	else
 		los = false;
 		
 	// if the enemy can see the hero, it pursues.
 	// otherwise, it will head towards where it last saw the hero
-	if (los && dist < stats.threat_range) {
-		stats.in_combat = true;
+	if (los && dist < threatRange()) {
+		inCombat() = true;
 		stats.last_seen.x = stats.hero_pos.x;
 		stats.last_seen.y = stats.hero_pos.y;
 	}
 	else if (stats.last_seen.x >= 0 && stats.last_seen.y >= 0) {
-		if (getDistance(stats.last_seen) <= (stats.speed+stats.speed) && stats.patrol_ticks == 0) {
+		if (getDistance(stats.last_seen) <= (stats.speed+stats.speed) && patrolTicks() == 0) {
 			stats.last_seen.x = -1;
 			stats.last_seen.y = -1;
-			stats.patrol_ticks = 8; // start patrol; see note on "patrolling" below
+			patrolTicks() = 8; // start patrol; see note on "patrolling" below
 		}		
 	}
 	
@@ -159,23 +310,26 @@ void Enemy::logic() {
 	if (los) {
 		pursue_pos.x = stats.last_seen.x = stats.hero_pos.x;
 		pursue_pos.y = stats.last_seen.y = stats.hero_pos.y;
-		stats.patrol_ticks = 0;
+		patrolTicks() = 0;
+		path.clear();
 	}
-	else if (stats.in_combat) {
+	else if (inCombat()) {
 	
 		// "patrolling" is a simple way to help steering.
 		// When the enemy arrives at where he last saw the hero, it continues
 		// walking a few steps.  This gives a better chance of re-establishing
 		// line of sight around corners.
 		
-		if (stats.patrol_ticks > 0) {
-			stats.patrol_ticks--;
-			if (stats.patrol_ticks == 0) {
-				stats.in_combat = false;
+		if (patrolTicks() > 0) {
+			patrolTicks()--;
+			if (patrolTicks() == 0) {
+				inCombat() = false;
 			}			
 		}
 		pursue_pos.x = stats.last_seen.x;
 		pursue_pos.y = stats.last_seen.y;
+		if (pursue_pos.x >= 0 && pursue_pos.y >= 0)
+			pursue_pos = followPath(pursue_pos);
 	}
 
 
@@ -185,27 +339,27 @@ void Enemy::logic() {
 	
 	activeAnimation->advanceFrame();
 
-	switch(stats.cur_state) {
+	switch(curState()) {
 	
 		case ENEMY_STANCE:
 		
-			setAnimation("stance");
+			setAnimation(ATOM_STANCE);
 			
-			if (stats.in_combat) {
+			if (inCombat()) {
 
 				// update direction to face the target
-				if (++stats.dir_ticks > stats.dir_favor && stats.patrol_ticks == 0) {
-					stats.direction = face(pursue_pos.x, pursue_pos.y);				
-					stats.dir_ticks = 0;
+				if (++dirTicks() > stats.dir_favor && patrolTicks() == 0) {
+					direction() = face(pursue_pos.x, pursue_pos.y);				
+					dirTicks() = 0;
 				}
 		
 				// performed ranged actions
-				if (dist > stats.melee_range && stats.cooldown_ticks == 0) {
+				if (dist > stats.melee_range && cooldownTicks() == 0) {
 
 					// CHECK: ranged physical!
 					//if (!powers->powers[stats.power_index[RANGED_PHYS]].requires_los || los) {
 					if (los) {
-						if ((rand() % 100) < stats.power_chance[RANGED_PHYS] && stats.power_ticks[RANGED_PHYS] == 0) {
+						if (percentRoll() < stats.power_chance[RANGED_PHYS] && stats.power_ticks[RANGED_PHYS] == 0) {
 							
 							newState(ENEMY_RANGED_PHYS);
 							break;
@@ -214,7 +368,7 @@ void Enemy::logic() {
 					// CHECK: ranged spell!
 					//if (!powers->powers[stats.power_index[RANGED_MENT]].requires_los || los) {
 					if (los) {			
-						if ((rand() % 100) < stats.power_index[RANGED_MENT] && stats.power_ticks[RANGED_MENT] == 0) {
+						if (percentRoll() < stats.power_index[RANGED_MENT] && stats.power_ticks[RANGED_MENT] == 0) {
 							
 							newState(ENEMY_RANGED_MENT);
 							break;
@@ -224,30 +378,30 @@ void Enemy::logic() {
 					// CHECK: flee!
 					
 					// CHECK: pursue!
-					if ((rand() % 100) < stats.chance_pursue) {
+					if (percentRoll() < stats.chance_pursue) {
 						if (move()) { // no collision
 							newState(ENEMY_MOVE);
 						}
 						else {
 							// hit an obstacle, try the next best angle
-							prev_direction = stats.direction;
-							stats.direction = faceNextBest(pursue_pos.x, pursue_pos.y);
+							prev_direction = direction();
+							direction() = faceNextBest(pursue_pos.x, pursue_pos.y);
 							if (move()) {
 								newState(ENEMY_MOVE);
 								break;
 							}
-							else stats.direction = prev_direction;
+							else direction() = prev_direction;
 						}
 					}
 					
 				}
 				// perform melee actions
-				else if (dist <= stats.melee_range && stats.cooldown_ticks == 0) {
+				else if (dist <= stats.melee_range && cooldownTicks() == 0) {
 				
 					// CHECK: melee attack!
 					//if (!powers->powers[stats.power_index[MELEE_PHYS]].requires_los || los) {
 					if (los) {
-						if ((rand() % 100) < stats.power_chance[MELEE_PHYS] && stats.power_ticks[MELEE_PHYS] == 0) {
+						if (percentRoll() < stats.power_chance[MELEE_PHYS] && stats.power_ticks[MELEE_PHYS] == 0) {
 							
 							newState(ENEMY_MELEE_PHYS);
 							break;
@@ -256,7 +410,7 @@ void Enemy::logic() {
 					// CHECK: melee ment!
 					//if (!powers->powers[stats.power_index[MELEE_MENT]].requires_los || los) {
 					if (los) {
-						if ((rand() % 100) < stats.power_chance[MELEE_MENT] && stats.power_ticks[MELEE_MENT] == 0) {
+						if (percentRoll() < stats.power_chance[MELEE_MENT] && stats.power_ticks[MELEE_MENT] == 0) {
 													
 							newState(ENEMY_MELEE_MENT);
 							break;
@@ -269,21 +423,21 @@ void Enemy::logic() {
 		
 		case ENEMY_MOVE:
 		
-			setAnimation("run");
+			setAnimation(ATOM_RUN);
 	
-			if (stats.in_combat) {
+			if (inCombat()) {
 
-				if (++stats.dir_ticks > stats.dir_favor && stats.patrol_ticks == 0) {
-					stats.direction = face(pursue_pos.x, pursue_pos.y);				
-					stats.dir_ticks = 0;
+				if (++dirTicks() > stats.dir_favor && patrolTicks() == 0) {
+					direction() = face(pursue_pos.x, pursue_pos.y);				
+					dirTicks() = 0;
 				}
 				
-				if (dist > stats.melee_range && stats.cooldown_ticks == 0) {
+				if (dist > stats.melee_range && cooldownTicks() == 0) {
 				
 					// check ranged physical!
 					//if (!powers->powers[stats.power_index[RANGED_PHYS]].requires_los || los) {
 					if (los) {
-						if ((rand() % 100) < stats.power_chance[RANGED_PHYS] && stats.power_ticks[RANGED_PHYS] == 0) {
+						if (percentRoll() < stats.power_chance[RANGED_PHYS] && stats.power_ticks[RANGED_PHYS] == 0) {
 							
 							newState(ENEMY_RANGED_PHYS);
 							break;
@@ -292,7 +446,7 @@ void Enemy::logic() {
 					// check ranged spell!
 					// if (!powers->powers[stats.power_index[RANGED_MENT]].requires_los || los) {
 					if (los) {
-						if ((rand() % 100) < stats.power_chance[RANGED_MENT] && stats.power_ticks[RANGED_MENT] == 0) {
+						if (percentRoll() < stats.power_chance[RANGED_MENT] && stats.power_ticks[RANGED_MENT] == 0) {
 							
 							newState(ENEMY_RANGED_MENT);
 							break;
@@ -301,11 +455,11 @@ void Enemy::logic() {
 				
 					if (!move()) {
 						// hit an obstacle.  Try the next best angle
-						prev_direction = stats.direction;
-						stats.direction = faceNextBest(pursue_pos.x, pursue_pos.y);
+						prev_direction = direction();
+						direction() = faceNextBest(pursue_pos.x, pursue_pos.y);
 						if (!move()) {
 							newState(ENEMY_STANCE);
-							stats.direction = prev_direction;
+							direction() = prev_direction;
 						}
 					}
 				}
@@ -320,7 +474,7 @@ void Enemy::logic() {
 			
 		case ENEMY_MELEE_PHYS:
 			
-			setAnimation("melee");
+			setAnimation(ATOM_MELEE);
 
 			if (activeAnimation->getCurFrame() == 1) {
 				sfx_phys = true;
@@ -328,22 +482,22 @@ void Enemy::logic() {
 
 			// the attack hazard is alive for a single frame
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()/2 && haz == NULL) {
-				powers->activate(stats.power_index[MELEE_PHYS], &stats, pursue_pos);
+				queue(ENEMY_CMD_POWER, stats.power_index[MELEE_PHYS], pursue_pos);
 				stats.power_ticks[MELEE_PHYS] = stats.power_cooldown[MELEE_PHYS];
 			}
 
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()-1) {
 				newState(ENEMY_STANCE);
-				stats.cooldown_ticks = stats.cooldown;
+				cooldownTicks() = stats.cooldown;
 			}
 			break;
 
 		case ENEMY_RANGED_PHYS:
 
-			setAnimation("ranged");
+			setAnimation(ATOM_RANGED);
 	
 			// monsters turn to keep aim at the hero
-			stats.direction = face(pursue_pos.x, pursue_pos.y);
+			direction() = face(pursue_pos.x, pursue_pos.y);
 			
 			if (activeAnimation->getCurFrame() == 1) {
 				sfx_phys = true;
@@ -351,20 +505,20 @@ void Enemy::logic() {
 			
 			// the attack hazard is alive for a single frame
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()/2 && haz == NULL) {
-				powers->activate(stats.power_index[RANGED_PHYS], &stats, pursue_pos);
+				queue(ENEMY_CMD_POWER, stats.power_index[RANGED_PHYS], pursue_pos);
 				stats.power_ticks[RANGED_PHYS] = stats.power_cooldown[RANGED_PHYS];
 			}
 			
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()-1) {
 				newState(ENEMY_STANCE);
-				stats.cooldown_ticks = stats.cooldown;
+				cooldownTicks() = stats.cooldown;
 			}
 			break;
 
 		
 		case ENEMY_MELEE_MENT:
 	
-			setAnimation("ment");
+			setAnimation(ATOM_MENT);
 
 			if (activeAnimation->getCurFrame() == 1) {
 				sfx_ment = true;
@@ -372,22 +526,22 @@ void Enemy::logic() {
 			
 			// the attack hazard is alive for a single frame
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()/2 && haz == NULL) {
-				powers->activate(stats.power_index[MELEE_MENT], &stats, pursue_pos);
+				queue(ENEMY_CMD_POWER, stats.power_index[MELEE_MENT], pursue_pos);
 				stats.power_ticks[MELEE_MENT] = stats.power_cooldown[MELEE_MENT];
 			}
 			
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()-1) {
 				newState(ENEMY_STANCE);
-				stats.cooldown_ticks = stats.cooldown;
+				cooldownTicks() = stats.cooldown;
 			}
 			break;
 
 		case ENEMY_RANGED_MENT:
 
-			setAnimation("ment");
+			setAnimation(ATOM_MENT);
 		
 			// monsters turn to keep aim at the hero
-			stats.direction = face(pursue_pos.x, pursue_pos.y);
+			direction() = face(pursue_pos.x, pursue_pos.y);
 	
 			if (activeAnimation->getCurFrame() == 1) {
 				sfx_ment = true;
@@ -395,20 +549,20 @@ void Enemy::logic() {
 			
 			// the attack hazard is alive for a single frame
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()/2 && haz == NULL) {
-				powers->activate(stats.power_index[RANGED_MENT], &stats, pursue_pos);
+				queue(ENEMY_CMD_POWER, stats.power_index[RANGED_MENT], pursue_pos);
 				stats.power_ticks[RANGED_MENT] = stats.power_cooldown[RANGED_MENT];
 			}
 			
 			if (activeAnimation->getCurFrame() == activeAnimation->getMaxFrame()-1) {
 				newState(ENEMY_STANCE);
-				stats.cooldown_ticks = stats.cooldown;
+				cooldownTicks() = stats.cooldown;
 			}
 			break;
 	
 		case ENEMY_HIT:
 			// enemy has taken damage (but isn't dead)
 
-			setAnimation("hit");
+			setAnimation(ATOM_HIT);
 			if (activeAnimation->getCurFrame() == 1) {
 				sfx_hit = true;
 			}
@@ -422,12 +576,15 @@ void Enemy::logic() {
 		case ENEMY_DEAD:
 
 			// corpse means the creature is dead and done animating		
-			if (!stats.corpse) {
-				setAnimation("die");
+			if (!corpse()) {
+				setAnimation(ATOM_DIE);
 				
 				if (activeAnimation->getCurFrame() == 1) {
 					sfx_die = true;
 				}
+				if (activeAnimation->getTimesPlayed() >= 1) {
+					corpse() = true;
+				}
             }
 
 			break;
@@ -436,12 +593,15 @@ void Enemy::logic() {
 			// critdead is an optional, more gruesome death animation
 		
 			// corpse means the creature is dead and done animating
-			if (!stats.corpse) {
-				setAnimation("critdie");
+			if (!corpse()) {
+				setAnimation(ATOM_CRITDIE);
 				
 				if (activeAnimation->getCurFrame() == 1) {
 					sfx_critdie = true;
 				}
+				if (activeAnimation->getTimesPlayed() >= 1) {
+					corpse() = true;
+				}
 			}
 			
 			break;
@@ -455,11 +615,11 @@ void Enemy::logic() {
  *
  * Returns false on miss
  */
-bool Enemy::takeHit(Hazard h) {
-	if (stats.cur_state != ENEMY_DEAD && stats.cur_state != ENEMY_CRITDEAD) {
+bool Enemy::takeHit(const Hazard &h) {
+	if (curState() != ENEMY_DEAD && curState() != ENEMY_CRITDEAD) {
 	
-		if (!stats.in_combat) {
-			stats.in_combat = true;
+		if (!inCombat()) {
+			inCombat() = true;
 			stats.last_seen.x = stats.hero_pos.x;
 			stats.last_seen.y = stats.hero_pos.y;
 		}
@@ -508,13 +668,13 @@ bool Enemy::takeHit(Hazard h) {
 		}
 		
 		// apply damage
-		stats.takeDamage(dmg);
+		stats.takeDamage(dmg, hp());
 		
 		// damage always breaks stun
 		if (dmg > 0) stats.stun_duration=0;
 		
 		// after effects
-		if (stats.hp > 0) {
+		if (hp() > 0) {
 			if (h.stun_duration > stats.stun_duration) stats.stun_duration = h.stun_duration;
 			if (h.slow_duration > stats.slow_duration) stats.slow_duration = h.slow_duration;
 			if (h.bleed_duration > stats.bleed_duration) stats.bleed_duration = h.bleed_duration;
@@ -533,23 +693,25 @@ bool Enemy::takeHit(Hazard h) {
 		Point pt;
 		pt.x = pt.y = 0;
 		if (h.post_power >= 0 && dmg > 0) {
+			lendStats();
 			powers->activate(h.post_power, &stats, pt);
+			returnStats();
 		}
 		
 		// interrupted to new state
 		if (dmg > 0) {
 			
-			if (stats.hp <= 0 && crit) {
+			if (hp() <= 0 && crit) {
 				doRewards();
-				stats.cur_state = ENEMY_CRITDEAD;
+				curState() = ENEMY_CRITDEAD;
 			}
-			else if (stats.hp <= 0) {
+			else if (hp() <= 0) {
 				doRewards();
-				stats.cur_state = ENEMY_DEAD;		
+				curState() = ENEMY_DEAD;		
 			}
 			// don't go through a hit animation if stunned
 			else if (h.stun_duration == 0) {
-				stats.cur_state = ENEMY_HIT;
+				curState() = ENEMY_HIT;
 			}
 		}
 		
@@ -570,7 +732,7 @@ void Enemy::doRewards() {
 	reward_xp = true;
 	
 	// some creatures create special loot if we're on a quest
-	if (stats.quest_loot_requires != "") {
+	if (stats.quest_loot_requires != ATOM_NONE) {
 	
 		// the loot manager will check quest_loot_id
 		// if set (not zero), the loot manager will 100% generate that loot.
@@ -592,7 +754,7 @@ void Enemy::doRewards() {
 	}
 	
 	// defeating some creatures (e.g. bosses) affects the story
-	if (stats.defeat_status != "") {
+	if (stats.defeat_status != ATOM_NONE) {
 		map->camp->setStatus(stats.defeat_status);
 	}
 
@@ -604,12 +766,12 @@ void Enemy::doRewards() {
  * to collect all mobile sprites each frame.
  */
 Renderable Enemy::getRender() {
-	Renderable r = activeAnimation->getCurrentFrame(stats.direction);
-	r.map_pos.x = stats.pos.x;
-	r.map_pos.y = stats.pos.y;
+	Renderable r = activeAnimation->getCurrentFrame(direction());
+	r.map_pos.x = pos().x;
+	r.map_pos.y = pos().y;
 
 	// draw corpses below objects so that floor loot is more visible
-	r.object_layer = !stats.corpse;
+	r.object_layer = !corpse();
 
 	return r;	
 }
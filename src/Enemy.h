@@ -40,10 +40,53 @@ const int ENEMY_HIT = 8;
 const int ENEMY_DEAD = 9;
 const int ENEMY_CRITDEAD = 10;
 
+// side effects Enemy::logic() queues for EnemyManager to apply
+const int ENEMY_CMD_POWER = 0;   // powers->activate(power, &stats, target)
+const int ENEMY_CMD_REWARDS = 1; // doRewards()
+const int ENEMY_CMD_PATH = 2;    // find a path to target
+
+struct Enemy_Command {
+	int type;
+	int power;
+	Point target;
+};
+
+// the state every enemy reads or changes each frame, one column per field,
+// owned by EnemyManager and indexed like EnemyManager::enemies.
+// An enemy's StatBlock still holds these fields from its definition file,
+// but once bound they are only used when the StatBlock is lent to
+// code shared with the hero (see Enemy::lendStats)
+struct Enemy_Columns {
+	vector<Point> pos;
+	vector<int> direction;
+	vector<int> state;
+	vector<int> hp;
+	vector<int> cooldown_ticks;
+	vector<int> dir_ticks;
+	vector<int> patrol_ticks;
+	vector<int> threat_range;
+	vector<char> in_combat;
+	vector<char> corpse;
+	
+	void resize(int count);
+};
+
 class Enemy : public Entity {
 protected:
 	PowerManager *powers;
 	
+	// this enemy's own random stream, so its choices don't depend on
+	// which thread runs it or in which order
+	Uint32 rng;
+	int percentRoll();
+	void queue(int type, int power, Point target);
+	
+	Enemy_Columns *columns;
+	int index;
+	
+	bool move();
+	int face(int mapx, int mapy);
+	
 public:
 	Enemy(PowerManager *_powers, MapIso *_map);
 	~Enemy();
@@ -52,13 +95,37 @@ public:
 	int faceNextBest(int mapx, int mapy);
 	void newState(int state);
 	int getDistance(Point dest);
-	bool takeHit(Hazard h);
+	Point followPath(Point target);
+	void seedRandom(Uint32 seed);
+	void bind(Enemy_Columns *_columns, int _index);
+	void lendStats();
+	void returnStats();
+	void commit();
+	bool takeHit(const Hazard &h);
 	void doRewards();
 
 	virtual Renderable getRender();
 	
+	// this enemy's row of the columns
+	Point &pos() { return columns->pos[index]; }
+	int &direction() { return columns->direction[index]; }
+	int &curState() { return columns->state[index]; }
+	int &hp() { return columns->hp[index]; }
+	int &cooldownTicks() { return columns->cooldown_ticks[index]; }
+	int &dirTicks() { return columns->dir_ticks[index]; }
+	int &patrolTicks() { return columns->patrol_ticks[index]; }
+	int &threatRange() { return columns->threat_range[index]; }
+	char &inCombat() { return columns->in_combat[index]; }
+	char &corpse() { return columns->corpse[index]; }
+	
 	Hazard *haz;
 
+	// route around walls while chasing the hero out of sight
+	vector<Point> path;
+	Point path_goal;
+	
+	vector<Enemy_Command> commands;
+
 	// sound effects flags
 	bool sfx_phys;
 	bool sfx_ment;
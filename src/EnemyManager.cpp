@@ -16,6 +16,13 @@ EnemyManager::EnemyManager(PowerManager *_powers, MapIso *_map) {
 	gfx_count = 0;
 	hero_pos.x = hero_pos.y = -1;
 	hero_alive = true;
+	lod_frame = 0;
+#ifdef ENEMY_STRESS_TEST
+	stress_frames = 0;
+	stress_ticks = 0;
+#endif
+	pool = NULL;
+	workers.init(AI_THREADS);
 	handleNewMap();
 }
 
@@ -23,47 +30,55 @@ EnemyManager::EnemyManager(PowerManager *_powers, MapIso *_map) {
 
 /**
  * Enemies share graphic/sound resources (usually there are groups of similar enemies)
+ * Sheets are packed into trimmed atlases laid out in cells of frame_size
+ *
+ * @return index of the shared atlas, or -1 if none could be assigned
  */
-void EnemyManager::loadGraphics(string type_id) {
-	
-	// TODO: throw an error if a map tries to use too many monsters
-	if (gfx_count == max_gfx) return;
+int EnemyManager::loadGraphics(string type_id, Point frame_size) {
 	
 	// first check to make sure the sprite isn't already loaded
 	for (int i=0; i<gfx_count; i++) {
 		if (gfx_prefixes[i] == type_id) {
-			return; // already have this one
+			return i; // already have this one
 		}
 	}
 
-	sprites[gfx_count] = IMG_Load(("images/enemies/" + type_id + ".png").c_str());
-	if(!sprites[gfx_count]) {
+	// TODO: throw an error if a map tries to use too many monsters
+	if (gfx_count == max_gfx) return -1;
+	
+	SDL_Surface *sheet = IMG_Load(("images/enemies/" + type_id + ".png").c_str());
+	if(!sheet) {
 		fprintf(stderr, "Couldn't load image: %s\n", IMG_GetError());
 		SDL_Quit();
+		return -1;
 	}
-	SDL_SetColorKey( sprites[gfx_count], SDL_SRCCOLORKEY, SDL_MapRGB(sprites[gfx_count]->format, 255, 0, 255) ); 
+	SDL_SetColorKey( sheet, SDL_SRCCOLORKEY, SDL_MapRGB(sheet->format, 255, 0, 255) ); 
 
 	// optimize
-	SDL_Surface *cleanup = sprites[gfx_count];
-	sprites[gfx_count] = SDL_DisplayFormatAlpha(sprites[gfx_count]);
-	SDL_FreeSurface(cleanup);	
+	sheet = optimizeSurface(sheet);
+	
+	sprites[gfx_count].build(sheet, frame_size);
+	SDL_FreeSurface(sheet);
 	
 	gfx_prefixes[gfx_count] = type_id;
-	gfx_count++;
+	return gfx_count++;
 
 }
 
-void EnemyManager::loadSounds(string type_id) {
+/**
+ * @return index of the shared sounds, or -1 if none could be assigned
+ */
+int EnemyManager::loadSounds(string type_id) {
 
-	// TODO: throw an error if a map tries to use too many monsters
-	if (sfx_count == max_sfx) return;
-	
 	// first check to make sure the sprite isn't already loaded
 	for (int i=0; i<sfx_count; i++) {
 		if (sfx_prefixes[i] == type_id) {
-			return; // already have this one
+			return i; // already have this one
 		}
 	}
+
+	// TODO: throw an error if a map tries to use too many monsters
+	if (sfx_count == max_sfx) return -1;
 	
 	sound_phys[sfx_count] = Mix_LoadWAV(("soundfx/enemies/" + type_id + "_phys.ogg").c_str());
 	sound_ment[sfx_count] = Mix_LoadWAV(("soundfx/enemies/" + type_id + "_ment.ogg").c_str());
@@ -72,7 +87,20 @@ void EnemyManager::loadSounds(string type_id) {
 	sound_critdie[sfx_count] = Mix_LoadWAV(("soundfx/enemies/" + type_id + "_critdie.ogg").c_str());
 	
 	sfx_prefixes[sfx_count] = type_id;
-	sfx_count++;
+	return sfx_count++;
+}
+
+/**
+ * Destroy all enemies and release the block they live in
+ */
+void EnemyManager::clearPool() {
+	for (int i=0; i<enemy_count; i++) {
+		enemies[i]->~Enemy();
+	}
+	operator delete(pool);
+	pool = NULL;
+	enemies.clear();
+	enemy_count = 0;
 }
 
 /**
@@ -84,14 +112,11 @@ void EnemyManager::handleNewMap () {
 	Map_Enemy me;
 	
 	// delete existing enemies
-	for (int i=0; i<enemy_count; i++) {
-		delete(enemies[i]);
-	}
-	enemy_count = 0;
+	clearPool();
 	
 	// free shared resources
 	for (int j=0; j<gfx_count; j++) {
-		SDL_FreeSurface(sprites[j]);
+		sprites[j].clear();
 	}
 	for (int j=0; j<sfx_count; j++) {
 		Mix_FreeChunk(sound_phys[j]);
@@ -102,51 +127,218 @@ void EnemyManager::handleNewMap () {
 	}
 	gfx_count = 0;
 	sfx_count = 0;
+	for (std::map<string, Enemy_Prototype>::iterator it = prototypes.begin(); it != prototypes.end(); it++) {
+		it->second.resolved = false;
+	}
+	
+	grid.init(map->w, map->h);
+	max_render_size.x = max_render_size.y = 0;
+	
+#ifdef ENEMY_STRESS_TEST
+	addStressEnemies();
+#endif
+	
+	// load new enemies, all of them in one block
+	enemy_count = map->enemies.size();
+	if (enemy_count > 0)
+		pool = (Enemy*)operator new(enemy_count * sizeof(Enemy));
+	enemies.resize(enemy_count);
+	columns.resize(enemy_count);
+	skipped_frames.assign(enemy_count, 0);
+	sfx_ids.resize(enemy_count);
+	filed_pos.resize(enemy_count);
+	listed.assign(enemy_count, 0);
+	awake.clear();
 	
-	// load new enemies
-	while (!map->enemies.empty()) {
+	for (int i=0; i<enemy_count; i++) {
 		me = map->enemies.front();
 		map->enemies.pop();
 		
-		enemies[enemy_count] = new Enemy(powers, map);
-		enemies[enemy_count]->stats.pos.x = me.pos.x;
-		enemies[enemy_count]->stats.pos.y = me.pos.y;
-		enemies[enemy_count]->stats.direction = me.direction;
-		enemies[enemy_count]->stats.load("enemies/" + me.type + ".txt");
-		if (enemies[enemy_count]->stats.animations != "") {
+		Enemy_Prototype *proto = getPrototype(me.type);
+		
+		enemies[i] = new(&pool[i]) Enemy(powers, map);
+		enemies[i]->seedRandom(rand() * 2654435761u + i);
+		enemies[i]->stats = proto->stats;
+		enemies[i]->stats.pos.x = me.pos.x;
+		enemies[i]->stats.pos.y = me.pos.y;
+		enemies[i]->stats.direction = me.direction;
+		if (enemies[i]->stats.animations != "") {
 			// load the animation file if specified
-			enemies[enemy_count]->loadAnimations("./animations/" + enemies[enemy_count]->stats.animations + ".txt");
+			enemies[i]->loadAnimations("./animations/" + enemies[i]->stats.animations + ".txt");
 		}
-		else {
-			cout << "Warning: no animation file specified for entity: " << me.type << endl;
+		
+		// the first enemy of each type on the map picks its sprites and sounds
+		if (!proto->resolved) {
+			proto->gfx_id = loadGraphics(proto->stats.gfx_prefix, enemies[i]->getRenderSize());
+			proto->sfx_id = loadSounds(proto->stats.sfx_prefix);
+			proto->resolved = true;
 		}
-		loadGraphics(enemies[enemy_count]->stats.gfx_prefix);
-		loadSounds(enemies[enemy_count]->stats.sfx_prefix);
-		enemy_count++;
+		if (proto->gfx_id != -1) enemies[i]->setAtlas(&sprites[proto->gfx_id]);
+		sfx_ids[i] = proto->sfx_id;
+		
+		Point size = enemies[i]->getRenderSize();
+		max_render_size.x = max(max_render_size.x, size.x);
+		max_render_size.y = max(max_render_size.y, size.y);
+		enemies[i]->bind(&columns, i);
+		filed_pos[i] = columns.pos[i];
+		grid.insert(i, filed_pos[i]);
 	}
 }
 
+#ifdef ENEMY_STRESS_TEST
+/**
+ * Stress test build (-DENEMY_STRESS_TEST=<count>): queue copies of the map's
+ * enemies on open tiles until there are ENEMY_STRESS_TEST of them.
+ * The tiles come from a fixed seed, so every run of a map gets the same crowd.
+ */
+void EnemyManager::addStressEnemies() {
+	int count = map->enemies.size();
+	if (count == 0 || count >= ENEMY_STRESS_TEST || map->w <= 0 || map->h <= 0) return;
+	
+	vector<Map_Enemy> types;
+	for (int i=0; i<count; i++) {
+		types.push_back(map->enemies.front());
+		map->enemies.pop();
+		map->enemies.push(types.back());
+	}
+	
+	Uint32 seed = 12345;
+	int tries = ENEMY_STRESS_TEST * 100;
+	while (count < ENEMY_STRESS_TEST && tries-- > 0) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		int x = (seed >> 8) % map->w;
+		int y = (seed >> 20) % map->h;
+		
+		Map_Enemy me = types[count % types.size()];
+		me.pos.x = x * UNITS_PER_TILE + UNITS_PER_TILE/2;
+		me.pos.y = y * UNITS_PER_TILE + UNITS_PER_TILE/2;
+		if (!map->collider.is_empty(me.pos.x, me.pos.y)) continue;
+		map->enemies.push(me);
+		count++;
+	}
+	fprintf(stderr, "enemy stress test: %d enemies on this map\n", count);
+}
+#endif
+
+/**
+ * Enemy definitions are only parsed the first time a type spawns.
+ * The definition is loaded into a fresh Enemy so the template starts from
+ * the same defaults a new enemy has.
+ */
+Enemy_Prototype *EnemyManager::getPrototype(string type) {
+	std::map<string, Enemy_Prototype>::iterator it = prototypes.find(type);
+	if (it != prototypes.end()) return &it->second;
+	
+	Enemy e(powers, map);
+	e.stats.load("enemies/" + type + ".txt");
+	if (e.stats.animations == "") {
+		cout << "Warning: no animation file specified for entity: " << type << endl;
+	}
+	
+	Enemy_Prototype &proto = prototypes[type];
+	proto.stats = e.stats;
+	proto.resolved = false;
+	proto.gfx_id = -1;
+	proto.sfx_id = -1;
+	return &proto;
+}
+
+void EnemyManager::markAwake(int i) {
+	if (listed[i]) return;
+	listed[i] = 1;
+	awake.push_back(i);
+}
+
+/**
+ * Catch up on the frames skipped while this enemy was not simulated
+ */
+void EnemyManager::wake(int i) {
+	if (skipped_frames[i] == 0) return;
+	enemies[i]->stats.skipTicks(skipped_frames[i], columns.hp[i], columns.cooldown_ticks[i]);
+	skipped_frames[i] = 0;
+}
+
+/**
+ * Resolve a hazard against one enemy; a sleeping enemy catches up before the hit lands
+ * Called by HazardManager
+ *
+ * Returns false on miss
+ */
+bool EnemyManager::hitEnemy(int i, const Hazard &h) {
+	wake(i);
+	bool hit = enemies[i]->takeHit(h);
+	markAwake(i);
+	return hit;
+}
+
+bool EnemyManager::isAlive(int i) {
+	return columns.hp[i] > 0;
+}
+
+Point EnemyManager::getPos(int i) {
+	return columns.pos[i];
+}
+
+/**
+ * The enemy whose StatBlock a hazard came from, or NULL for the hero's
+ */
+Enemy *EnemyManager::sourceOf(StatBlock *src_stats) {
+	for (int i=0; i<enemy_count; i++) {
+		if (&enemies[i]->stats == src_stats) return enemies[i];
+	}
+	return NULL;
+}
+
+/**
+ * How closely to simulate an enemy this frame.
+ * Enemies that could matter to the hero soon (in combat, within the distance
+ * they chase from, or on screen) run every frame; the rest slow down and
+ * then sleep with distance.
+ */
+int EnemyManager::detailLevel(int i) {
+	if (columns.in_combat[i]) return ENEMY_ACTIVE;
+	if (columns.state[i] == ENEMY_DEAD || columns.state[i] == ENEMY_CRITDEAD) return ENEMY_ACTIVE;
+
+	int dx = columns.pos[i].x - hero_pos.x;
+	int dy = columns.pos[i].y - hero_pos.y;
+	int dist_squared = dx*dx + dy*dy;
+	int range = columns.threat_range[i] * 2;
+	if (dist_squared < range * range) return ENEMY_ACTIVE;
+
+	Point p = map_to_screen(columns.pos[i].x, columns.pos[i].y, map->cam.x, map->cam.y);
+	if (p.x > -max_render_size.x && p.x < VIEW_W + max_render_size.x &&
+	    p.y > -max_render_size.y && p.y < VIEW_H + max_render_size.y)
+		return ENEMY_ACTIVE;
+
+	range = columns.threat_range[i] * 4;
+	if (dist_squared < range * range) return ENEMY_DROWSY;
+	return ENEMY_ASLEEP;
+}
+
 /**
  * perform logic() for all enemies
  */
 void EnemyManager::logic() {
-	int pref_id;
+#ifdef ENEMY_STRESS_TEST
+	Uint32 start_ticks = SDL_GetTicks();
+#endif
 
-	for (int i=0; i<enemy_count; i++) {
-	
-		// hazards are processed after Avatar and Enemy[]
-		// so process and clear sound effects from previous frames
-		// check sound effects
-		for (int j=0; j<sfx_count; j++) {
-			if (sfx_prefixes[j] == enemies[i]->stats.sfx_prefix)
-				pref_id = j;
-		}
+	// hazards are processed after Avatar and Enemy[]
+	// so process and clear sound effects from previous frames
+	// only enemies that acted or were hit can have any
+	for (unsigned k=0; k<awake.size(); k++) {
+		int i = awake[k];
+		int pref_id = sfx_ids[i];
 		
-		if (enemies[i]->sfx_phys) Mix_PlayChannel(-1, sound_phys[pref_id], 0);
-		if (enemies[i]->sfx_ment) Mix_PlayChannel(-1, sound_ment[pref_id], 0);
-		if (enemies[i]->sfx_hit) Mix_PlayChannel(-1, sound_hit[pref_id], 0);
-		if (enemies[i]->sfx_die) Mix_PlayChannel(-1, sound_die[pref_id], 0);		
-		if (enemies[i]->sfx_critdie) Mix_PlayChannel(-1, sound_critdie[pref_id], 0);		
+		if (pref_id != -1) {
+			if (enemies[i]->sfx_phys) Mix_PlayChannel(-1, sound_phys[pref_id], 0);
+			if (enemies[i]->sfx_ment) Mix_PlayChannel(-1, sound_ment[pref_id], 0);
+			if (enemies[i]->sfx_hit) Mix_PlayChannel(-1, sound_hit[pref_id], 0);
+			if (enemies[i]->sfx_die) Mix_PlayChannel(-1, sound_die[pref_id], 0);		
+			if (enemies[i]->sfx_critdie) Mix_PlayChannel(-1, sound_critdie[pref_id], 0);		
+		}
 		
 		// clear sound flags
 		enemies[i]->sfx_hit = false;
@@ -154,28 +346,106 @@ void EnemyManager::logic() {
 		enemies[i]->sfx_ment = false;
 		enemies[i]->sfx_die = false;
 		enemies[i]->sfx_critdie = false;
+		listed[i] = 0;
+	}
+	awake.clear();
+
+	// refresh the shared fields around the hero:
+	// sight reaches as far as any enemy notices the hero,
+	// pursuit as far as any enemy keeps chasing, which is
+	// twice its threat_range (see Enemy::logic)
+	int sight_range = 0;
+	int pursuit_range = 0;
+	for (int i=0; i<enemy_count; i++) {
+		if (columns.threat_range[i] > sight_range)
+			sight_range = columns.threat_range[i];
+		if (columns.in_combat[i] && columns.threat_range[i] > pursuit_range)
+			pursuit_range = columns.threat_range[i];
+	}
+	if (hero_alive && sight_range > 0)
+		map->fov.update(hero_pos, sight_range);
+	if (hero_alive && pursuit_range > 0)
+		map->flowfield.update(hero_pos, pursuit_range + pursuit_range);
+
+	active.clear();
+	for (int i=0; i<enemy_count; i++) {
+		
+		// dead and done animating
+		if (columns.corpse[i]) continue;
+		
+		// far away enemies only count the frames they skip
+		int lod = detailLevel(i);
+		if (lod == ENEMY_ASLEEP || (lod == ENEMY_DROWSY && (lod_frame + i) % ENEMY_LOD_INTERVAL != 0)) {
+			skipped_frames[i]++;
+			continue;
+		}
+		wake(i);
 		
 		// new actions this round
 		enemies[i]->stats.hero_pos = hero_pos;
 		enemies[i]->stats.hero_alive = hero_alive;
-		enemies[i]->logic();
+		active.push_back(i);
+	}
+	lod_frame++;
+	
+	// decide and move, possibly on several threads
+	workers.run(logicRange, this, active.size());
+	
+	// then apply what they queued one enemy at a time, always in index order,
+	// so the outcome doesn't depend on the number of threads
+	for (unsigned k=0; k<active.size(); k++) {
+		int i = active[k];
+		enemies[i]->commit();
+		
+		grid.move(i, filed_pos[i], columns.pos[i]);
+		filed_pos[i] = columns.pos[i];
+		markAwake(i);
+	}
 
+#ifdef ENEMY_STRESS_TEST
+	stress_ticks += SDL_GetTicks() - start_ticks;
+	if (++stress_frames == 300) {
+		fprintf(stderr, "enemy stress test: %d enemies, %.2f ms per frame of enemy logic\n", enemy_count, stress_ticks / 300.0);
+		stress_frames = 0;
+		stress_ticks = 0;
+	}
+#endif
+}
+
+/**
+ * Worker job: run logic() for active[begin] to active[end-1]
+ */
+void EnemyManager::logicRange(void *data, int begin, int end) {
+	EnemyManager *manager = (EnemyManager*)data;
+	for (int k=begin; k<end; k++) {
+		manager->enemies[manager->active[k]]->logic();
 	}
 }
 
 Enemy* EnemyManager::enemyFocus(Point mouse, Point cam, bool alive_only) {
 	Point p;
 	SDL_Rect r;
-	for(int i = 0; i < enemy_count; i++) {
-		if(alive_only && (enemies[i]->stats.cur_state == ENEMY_DEAD || enemies[i]->stats.cur_state == ENEMY_CRITDEAD)) {
+	
+	// only enemies standing near the cursor on screen can be under it
+	r.x = mouse.x - max_render_size.x;
+	r.y = mouse.y - max_render_size.y;
+	r.w = max_render_size.x * 2;
+	r.h = max_render_size.y * 2;
+	grid.queryScreen(r, cam, found);
+	
+	for (unsigned k = 0; k < found.size(); k++) {
+		int i = found[k];
+		if(alive_only && (columns.state[i] == ENEMY_DEAD || columns.state[i] == ENEMY_CRITDEAD)) {
 			continue;
 		}
-		p = map_to_screen(enemies[i]->stats.pos.x, enemies[i]->stats.pos.y, cam.x, cam.y);
+		p = map_to_screen(columns.pos[i].x, columns.pos[i].y, cam.x, cam.y);
 	
-		r.w = enemies[i]->getRender().src.x;
-		r.h = enemies[i]->getRender().src.y;
-		r.x = p.x - enemies[i]->getRender().offset.x;
-		r.y = p.y - enemies[i]->getRender().offset.y;
+		// the trimmed frame is exactly the visible part of the sprite
+		Renderable ren = enemies[i]->getRender();
+		r.w = ren.src.w;
+		r.h = ren.src.h;
+		r.x = p.x - ren.offset.x;
+		r.y = p.y - ren.offset.y;
 		
 		if (isWithin(r, mouse)) {
 			Enemy *enemy = enemies[i];
@@ -185,11 +455,31 @@ Enemy* EnemyManager::enemyFocus(Point mouse, Point cam, bool alive_only) {
 	return NULL;
 }
 
+/**
+ * Enemies whose sprite may show on the view with the camera at cam
+ */
+void EnemyManager::onScreen(Point cam, vector<int> &result) {
+	SDL_Rect view;
+	view.x = -max_render_size.x;
+	view.y = -max_render_size.y;
+	view.w = VIEW_W + max_render_size.x * 2;
+	view.h = VIEW_H + max_render_size.y * 2;
+	grid.queryScreen(view, cam, found);
+	
+	// the grid answers with a map-aligned box around the view; keep the ones inside
+	result.clear();
+	for (unsigned k = 0; k < found.size(); k++) {
+		Point p = map_to_screen(columns.pos[found[k]].x, columns.pos[found[k]].y, cam.x, cam.y);
+		if (isWithin(view, p)) result.push_back(found[k]);
+	}
+}
+
 /**
  * If an enemy has died, reward the hero with experience points
  */
 void EnemyManager::checkEnemiesforXP(StatBlock *stats) {
-	for (int i=0; i<enemy_count; i++) {
+	for (unsigned k=0; k<awake.size(); k++) {
+		int i = awake[k];
 		if (enemies[i]->reward_xp) {
 			stats->xp += enemies[i]->stats.level;
 			enemies[i]->reward_xp = false; // clear flag
@@ -202,25 +492,15 @@ void EnemyManager::checkEnemiesforXP(StatBlock *stats) {
  * Map objects need to be drawn in Z order, so we allow a parent object (GameEngine)
  * to collect all mobile sprites each frame.
  * 
- * This wrapper function is necessary because EnemyManager holds shared sprites for identical-looking enemies
+ * Identical-looking enemies share one atlas held by EnemyManager
  */
 Renderable EnemyManager::getRender(int enemyIndex) {
-	Renderable r = enemies[enemyIndex]->getRender();
-	for (int i=0; i<gfx_count; i++) {
-		if (gfx_prefixes[i] == enemies[enemyIndex]->stats.gfx_prefix)
-			r.sprite = sprites[i];
-	}
-	return r;	
+	return enemies[enemyIndex]->getRender();
 }
 
 EnemyManager::~EnemyManager() {
-	for (int i=0; i<enemy_count; i++) {
-		delete enemies[i];
-	}
+	clearPool();
 	
-	for (int i=0; i<gfx_count; i++) {
-		SDL_FreeSurface(sprites[i]);
-	}
 	for (int i=0; i<sfx_count; i++) {
 		Mix_FreeChunk(sound_phys[i]);
 		Mix_FreeChunk(sound_ment[i]);
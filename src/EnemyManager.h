@@ -9,35 +9,96 @@
 #ifndef ENEMY_MANAGER_H
 #define ENEMY_MANAGER_H
 
+#include <map>
+#include <new>
+#include <vector>
 #include "MapIso.h"
 #include "Enemy.h"
 #include "Utils.h"
 #include "PowerManager.h"
+#include "SpriteAtlas.h"
+#include "SpatialHash.h"
+#include "WorkerPool.h"
 
 // TODO: rename these to something more specific to EnemyManager
 const int max_sfx = 8;
 const int max_gfx = 32;
 
+// simulation level of detail
+const int ENEMY_ACTIVE = 0; // full logic every frame
+const int ENEMY_DROWSY = 1; // full logic every ENEMY_LOD_INTERVAL frames
+const int ENEMY_ASLEEP = 2; // no logic until woken
+const int ENEMY_LOD_INTERVAL = 4;
+
+// one enemy definition file, parsed once
+struct Enemy_Prototype {
+	StatBlock stats; // what a new enemy of this type starts with
+	
+	// shared resources on the current map
+	bool resolved;
+	int gfx_id;
+	int sfx_id;
+};
+
 class EnemyManager {
 private:
 
 	MapIso *map;
 	PowerManager *powers;
-	void loadGraphics(string type_id);
-	void loadSounds(string type_id);
+	int loadGraphics(string type_id, Point frame_size);
+	int loadSounds(string type_id);
 
 	string gfx_prefixes[max_gfx];
 	int gfx_count;
 	string sfx_prefixes[max_sfx];
 	int sfx_count;
 	
-	SDL_Surface *sprites[max_gfx];	
+	SpriteAtlas sprites[max_gfx];
 	Mix_Chunk *sound_phys[max_sfx];
 	Mix_Chunk *sound_ment[max_sfx];
 	Mix_Chunk *sound_hit[max_sfx];
 	Mix_Chunk *sound_die[max_sfx];
 	Mix_Chunk *sound_critdie[max_sfx];
 	
+	std::map<string, Enemy_Prototype> prototypes;
+	Enemy_Prototype *getPrototype(string type);
+	
+	// all enemies of the map are constructed in one block
+	Enemy *pool;
+	void clearPool();
+	
+	// per-frame state of every enemy; the Enemy objects read and write
+	// their own row, the sweeps below read whole columns
+	Enemy_Columns columns;
+	
+	// kept only here
+	vector<int> skipped_frames; // frames skipped by the level of detail, not yet applied to stats
+	vector<int> sfx_ids; // index into the sound arrays
+	vector<Point> filed_pos; // where each enemy is filed in the grid
+	
+	// enemies that ran logic or were hit since the last logic(),
+	// the only ones whose sound, loot, xp or hazard flags can be set
+	vector<char> listed;
+	void markAwake(int i);
+	
+	Point max_render_size; // largest enemy frame, bounds the screen area enemyFocus searches
+	vector<int> found;
+	
+	int lod_frame;
+	int detailLevel(int i);
+	void wake(int i);
+	
+	// enemies running logic this frame, in index order
+	vector<int> active;
+	WorkerPool workers;
+	static void logicRange(void *data, int begin, int end);
+
+#ifdef ENEMY_STRESS_TEST
+	void addStressEnemies();
+	int stress_frames;
+	Uint32 stress_ticks;
+#endif
+	
 public:
 	EnemyManager(PowerManager *_powers, MapIso *_map);
 	~EnemyManager();
@@ -46,12 +107,19 @@ public:
 	Renderable getRender(int enemyIndex);
 	void checkEnemiesforXP(StatBlock *stats);
 	Enemy *enemyFocus(Point mouse, Point cam, bool alive_only);
+	bool hitEnemy(int i, const Hazard &h);
+	bool isAlive(int i);
+	Point getPos(int i);
+	Enemy *sourceOf(StatBlock *src_stats);
+	void onScreen(Point cam, vector<int> &result);
 
 	// vars
-	Enemy *enemies[256]; // TODO: change to dynamic list without limits
+	vector<Enemy*> enemies; // points into pool
+	vector<int> awake; // see listed
 	Point hero_pos;
 	bool hero_alive;
 	int enemy_count;
+	SpatialHash grid; // enemy indices by position
 };
 
 
@@ -11,7 +11,7 @@
 
 #include "Entity.h"
 
-Entity::Entity(MapIso* _map) : sprites(NULL), activeAnimation(NULL), map(_map) {
+Entity::Entity(MapIso* _map) : sprites(NULL), animationSet(NULL), activeAnimation(NULL), map(_map) {
 }
 
 /**
@@ -21,6 +21,14 @@ Entity::Entity(MapIso* _map) : sprites(NULL), activeAnimation(NULL), map(_map) {
  * @return Returns false if wall collision, otherwise true.
  */
 bool Entity::move() {
+	return move(stats.pos, stats.direction);
+}
+
+/**
+ * move() for an entity whose position lives outside its StatBlock
+ * (enemies keep theirs in Enemy_Columns)
+ */
+bool Entity::move(Point &pos, int direction) {
 	if (stats.immobilize_duration > 0) return false;
 
 	int speed_diagonal = stats.dspeed;
@@ -35,23 +43,23 @@ bool Entity::move() {
 		speed_straight *= 2;
 	}
 	
-	switch (stats.direction) {
+	switch (direction) {
 		case 0:
-			return map->collider.move(stats.pos.x, stats.pos.y, -1, 1, speed_diagonal);
+			return map->collider.move(pos.x, pos.y, -1, 1, speed_diagonal);
 		case 1:
-			return map->collider.move(stats.pos.x, stats.pos.y, -1, 0, speed_straight);
+			return map->collider.move(pos.x, pos.y, -1, 0, speed_straight);
 		case 2:
-			return map->collider.move(stats.pos.x, stats.pos.y, -1, -1, speed_diagonal);
+			return map->collider.move(pos.x, pos.y, -1, -1, speed_diagonal);
 		case 3:
-			return map->collider.move(stats.pos.x, stats.pos.y, 0, -1, speed_straight);
+			return map->collider.move(pos.x, pos.y, 0, -1, speed_straight);
 		case 4:
-			return map->collider.move(stats.pos.x, stats.pos.y, 1, -1, speed_diagonal);
+			return map->collider.move(pos.x, pos.y, 1, -1, speed_diagonal);
 		case 5:
-			return map->collider.move(stats.pos.x, stats.pos.y, 1, 0, speed_straight);
+			return map->collider.move(pos.x, pos.y, 1, 0, speed_straight);
 		case 6:
-			return map->collider.move(stats.pos.x, stats.pos.y, 1, 1, speed_diagonal);
+			return map->collider.move(pos.x, pos.y, 1, 1, speed_diagonal);
 		case 7:
-			return map->collider.move(stats.pos.x, stats.pos.y, 0, 1, speed_straight);
+			return map->collider.move(pos.x, pos.y, 0, 1, speed_straight);
 	}
 	return true;
 }
@@ -60,9 +68,16 @@ bool Entity::move() {
  * Change direction to face the target map location
  */
 int Entity::face(int mapx, int mapy) {
+	return face(stats.pos, stats.direction, mapx, mapy);
+}
+
+/**
+ * face() from an explicit position; current is returned when no direction fits
+ */
+int Entity::face(Point from, int current, int mapx, int mapy) {
 	// inverting Y to convert map coordinates to standard cartesian coordinates
-	int dx = mapx - stats.pos.x;
-	int dy = stats.pos.y - mapy;
+	int dx = mapx - from.x;
+	int dy = from.y - mapy;
 
 	// avoid div by zero
 	if (dx == 0) {
@@ -87,137 +102,66 @@ int Entity::face(int mapx, int mapy) {
 		if (dy > 0) return 3;
 		else return 7;
 	}
-	return stats.direction;
+	return current;
 }
   
 /**
- * Load the entity's animation from animation definition file
+ * Load the entity's animation from animation definition file.
+ * Each file is only parsed once per animation speed; see AnimationSet.
  */
 void Entity::loadAnimations(std::string filename) {
 
-	FileParser parser;
-
-	if (!parser.open(filename)) {
-		cout << "Error loading animation definition file: " << filename << endl;
-		exit(1);
-	}
-
-	std::string name = "";
-	int position = 0;
-	int frames = 0;
-	int duration = 0;
-	Point render_size;
-	Point render_offset;
-	std::string type = "";
-	std::string firstAnimation = "";
-
-	// Parse the file and on each new section create an animation object from the data parsed previously
-
-	parser.next();
-	parser.new_section = false; // do not create the first animation object until parser has parsed first section
-
-	do {
-		// create the animation if finished parsing a section
-		if (parser.new_section) {
-			animations.push_back(new Animation(name, render_size, render_offset,  position, frames, duration, type));
-		}
-
-		if (parser.key == "position") {
-			if (isInt(parser.val)) {
-				position = atoi(parser.val.c_str());
-			}
-		}	
-		else if (parser.key == "frames") {
-			if (isInt(parser.val)) {
-				frames = atoi(parser.val.c_str());
-			}
-		}	
-		else if (parser.key == "duration") {
-			if (isInt(parser.val)) {
-				int ms_per_frame = atoi(parser.val.c_str());
-				
-				duration = round((float)ms_per_frame / (1000.0 / (float)FRAMES_PER_SEC));
-
-				// adjust duration according to the entity's animation speed
-				duration = (duration * 100) / stats.animationSpeed;
-				
-				// TEMP: if an animation is too fast, display one frame per fps anyway
-				if (duration < 1) duration=1;
-			}
-		}	
-		else if (parser.key == "type") {
-			type = parser.val;
-		}
-		else if (parser.key == "render_size_x") {
-			if (isInt(parser.val)) {
-				render_size.x = atoi(parser.val.c_str());
-			}
-		}	
-		else if (parser.key == "render_size_y") {
-			if (isInt(parser.val)) {
-				render_size.y = atoi(parser.val.c_str());
-			}
-		}	
-		else if (parser.key == "render_offset_x") {
-			if (isInt(parser.val)) {
-				render_offset.x = atoi(parser.val.c_str());
-			}
-		}	
-		else if (parser.key == "render_offset_y") {
-			if (isInt(parser.val)) {
-				render_offset.y = atoi(parser.val.c_str());
-			}
-		}	
-
-		if (name == "") {
-			// This is the first animation
-			firstAnimation = parser.section;
-		}
-		name = parser.section;
-	}
-	while (parser.next());
-
-	// add final animation
-	animations.push_back(new Animation(name, render_size, render_offset, position, frames, duration, type));
-
+	animationSet = AnimationSet::get(filename, stats.animationSpeed);
 
 	// set the default animation
-	if (firstAnimation != "") {
-		setAnimation(firstAnimation);
+	if (animationSet->first != ATOM_NONE) {
+		setAnimation(animationSet->first);
 	}
 }
 
 /**
  * Set the entity's current animation by name
+ *
+ * @param animationName Atom of the animation's section name, e.g. ATOM_STANCE
 */
-bool Entity::setAnimation(std::string animationName) {
+bool Entity::setAnimation(int animationName) {
 
 	// if the animation is already the requested one do nothing
 	if (activeAnimation != NULL && activeAnimation->getName() == animationName) {
 		return true;
 	}
+	if (animationSet == NULL) return false;
 
 	// search animations for the requested animation and set the active animation to it if found
-	for (vector<Animation*>::iterator it = animations.begin(); it!=animations.end(); it++) {
-		if ((*it) != NULL && (*it)->getName() == animationName) {
-			activeAnimation = *it;
-			activeAnimation->reset();
-			return true;
-		}
-	}
+	int id = animationSet->find(animationName);
+	if (id == -1) return false;
+	
+	animation.play(&animationSet->defs[id]);
+	activeAnimation = &animation;
+	return true;
+}
 
-	return false;
+/**
+ * Point all of this entity's animations at a packed sprite sheet
+ */
+void Entity::setAtlas(SpriteAtlas *atlas) {
+	animation.setAtlas(atlas);
+}
+
+/**
+ * Frame size of the entity's sprite sheet
+ */
+Point Entity::getRenderSize() {
+	if (activeAnimation != NULL) return activeAnimation->getRenderSize();
+	Point p;
+	p.x = p.y = 0;
+	return p;
 }
 
 void Entity::logic() {
 }
 
 Entity::~Entity () {
-	// delete all loaded animations
-	for (vector<Animation*>::const_iterator it = animations.begin(); it != animations.end(); it++)
-	{
-	    delete *it;
-	} 
-	animations.clear();
+	// animation sets are shared and outlive the entity
 }
 
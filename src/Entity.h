@@ -13,23 +13,26 @@
  */
 
 #include "MapIso.h"
-#include "Animation.h"
+#include "AnimationSet.h"
 #include "Utils.h"
 #include <vector>
 
 class Entity {
 protected:
-	MapIso* map;
-	vector<Animation*> animations;
-	Animation *activeAnimation;
 	SDL_Surface *sprites;
+	AnimationSet *animationSet; // shared with every entity using the same file
+	Animation animation; // this entity's playback state
+	Animation *activeAnimation; // &animation once an animation is set
+	MapIso* map;
 
 public:
 	Entity(MapIso*);
 	~Entity();
 
 	bool move();
+	bool move(Point &pos, int direction);
 	int face(int, int);
+	int face(Point from, int current, int mapx, int mapy);
 
 	// Logic common to all entities goes here
 	virtual void logic();
@@ -39,7 +42,9 @@ public:
 
 	void loadAnimations(std::string filename);
 
-	bool setAnimation(std::string animation);
+	bool setAnimation(int animation);
+	void setAtlas(SpriteAtlas *atlas);
+	Point getRenderSize();
 
 	StatBlock stats;
 };
@@ -0,0 +1,165 @@
+/**
+ * class EventScript
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "EventScript.h"
+
+EventScript::EventScript() {
+	clear();
+}
+
+void EventScript::clear() {
+	ops.clear();
+	entries.clear();
+	strings.clear();
+	strings.push_back(""); // string 0 is empty, for ops without text
+	
+	// op 0 is an empty program, run for programs that don't exist
+	Event_Op end;
+	end.op = OP_END;
+	end.s = end.x = end.y = end.z = 0;
+	ops.push_back(end);
+}
+
+/**
+ * Where a program starts
+ */
+int EventScript::entry(int program) {
+	if (program < 0 || program >= (int)entries.size()) return 0;
+	return entries[program];
+}
+
+int EventScript::addString(const string &s) {
+	if (s == "") return 0;
+	strings.push_back(s);
+	return strings.size() - 1;
+}
+
+/**
+ * Start a new, empty program; following add() calls append to it
+ *
+ * @return the program's id
+ */
+int EventScript::beginProgram() {
+	entries.push_back(ops.size());
+	Event_Op end;
+	end.op = OP_END;
+	end.s = end.x = end.y = end.z = 0;
+	ops.push_back(end);
+	return entries.size() - 1;
+}
+
+/**
+ * Compile one component onto the end of the current program.
+ * Components the interpreter can't run are dropped.
+ */
+void EventScript::add(const Event_Component &ec) {
+	Event_Op o;
+	o.s = 0;
+	o.x = ec.x;
+	o.y = ec.y;
+	o.z = ec.z;
+	
+	switch (ec.type) {
+		case ATOM_REQUIRES_STATUS: o.op = OP_REQUIRES_STATUS; o.s = atom(ec.s); break;
+		case ATOM_REQUIRES_NOT:    o.op = OP_REQUIRES_NOT;    o.s = atom(ec.s); break;
+		case ATOM_REQUIRES_ITEM:   o.op = OP_REQUIRES_ITEM;   break;
+		case ATOM_SET_STATUS:      o.op = OP_SET_STATUS;      o.s = atom(ec.s); break;
+		case ATOM_UNSET_STATUS:    o.op = OP_UNSET_STATUS;    o.s = atom(ec.s); break;
+		case ATOM_REMOVE_ITEM:     o.op = OP_REMOVE_ITEM;     break;
+		case ATOM_REWARD_XP:       o.op = OP_REWARD_XP;       break;
+		case ATOM_REWARD_CURRENCY: o.op = OP_REWARD_CURRENCY; break;
+		case ATOM_REWARD_ITEM:     o.op = OP_REWARD_ITEM;     break;
+		case ATOM_INTERMAP:        o.op = OP_INTERMAP;        o.s = addString(ec.s); break;
+		case ATOM_SOUNDFX:         o.op = OP_SOUNDFX;         o.s = addString(ec.s); break;
+		case ATOM_LOOT:            o.op = OP_LOOT;            o.s = addString(ec.s); break;
+		case ATOM_MSG:             o.op = OP_MSG;             o.s = addString(ec.s); break;
+		case ATOM_SHAKYCAM:        o.op = OP_SHAKYCAM;        break;
+		case ATOM_HIM:             o.op = OP_SAY_HIM;         o.s = addString(ec.s); break;
+		case ATOM_HER:             o.op = OP_SAY_HER;         o.s = addString(ec.s); break;
+		case ATOM_YOU:             o.op = OP_SAY_YOU;         o.s = addString(ec.s); break;
+		case ATOM_QUEST_TEXT:      o.op = OP_QUEST_TEXT;      o.s = addString(ec.s); break;
+		case ATOM_MAPMOD:
+			o.op = OP_MAPMOD;
+			if (ec.s == "collision") o.s = MAPMOD_COLLISION;
+			else if (ec.s == "object") o.s = MAPMOD_OBJECT;
+			else if (ec.s == "background") o.s = MAPMOD_BACKGROUND;
+			else return;
+			break;
+		default:
+			return;
+	}
+	
+	// the new op takes the place of the program's OP_END
+	ops.back() = o;
+	Event_Op end;
+	end.op = OP_END;
+	end.s = end.x = end.y = end.z = 0;
+	ops.push_back(end);
+}
+
+/**
+ * Run ops starting at pc.
+ *
+ * Stops at the program's OP_END, when the handler asks to stop, or in
+ * SCRIPT_CHECK mode at the first op that isn't a requirement.
+ *
+ * @return the index of the op it stopped at, or SCRIPT_FAILED if a requirement wasn't met
+ */
+int EventScript::run(int pc, int mode, CampaignManager *camp, EventHandler *handler) {
+	bool check = (mode != SCRIPT_RESUME);
+	
+	while (true) {
+		const Event_Op &o = ops[pc];
+		
+		switch (o.op) {
+			case OP_END:
+				return pc;
+				
+			case OP_REQUIRES_STATUS:
+				if (check && !camp->checkStatus(o.s)) return SCRIPT_FAILED;
+				break;
+			case OP_REQUIRES_NOT:
+				if (check && camp->checkStatus(o.s)) return SCRIPT_FAILED;
+				break;
+			case OP_REQUIRES_ITEM:
+				if (check && !camp->checkItem(o.x)) return SCRIPT_FAILED;
+				break;
+				
+			default:
+				if (mode == SCRIPT_CHECK) return pc;
+				
+				switch (o.op) {
+					case OP_SET_STATUS:
+						camp->setStatus(o.s);
+						break;
+					case OP_UNSET_STATUS:
+						camp->unsetStatus(o.s);
+						break;
+					case OP_REMOVE_ITEM:
+						camp->removeItem(o.x);
+						break;
+					case OP_REWARD_XP:
+						camp->rewardXP(o.x);
+						break;
+					case OP_REWARD_CURRENCY:
+						camp->rewardCurrency(o.x);
+						break;
+					case OP_REWARD_ITEM: {
+						ItemStack istack;
+						istack.item = o.x;
+						istack.quantity = o.y;
+						camp->rewardItem(istack);
+						break;
+					}
+					default:
+						if (handler != NULL && handler->eventOp(o, this)) return pc;
+						break;
+				}
+		}
+		pc++;
+	}
+}
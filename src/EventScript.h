@@ -0,0 +1,103 @@
+/**
+ * class EventScript
+ *
+ * Map events, NPC dialog and quests are lists of event components.
+ * They are compiled when loaded into programs of small fixed-size ops:
+ * the component type becomes an opcode, statuses become atoms and
+ * other text goes into a string table.  One interpreter runs all of them.
+ *
+ * Requirements and campaign effects (statuses, items, rewards) are handled
+ * here; everything else is passed to the owner's EventHandler.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef EVENT_SCRIPT_H
+#define EVENT_SCRIPT_H
+
+#include <string>
+#include <vector>
+#include "Utils.h"
+#include "CampaignManager.h"
+
+using namespace std;
+
+// opcodes
+const int OP_END = 0;
+const int OP_REQUIRES_STATUS = 1;
+const int OP_REQUIRES_NOT = 2;
+const int OP_REQUIRES_ITEM = 3;
+const int OP_SET_STATUS = 4;
+const int OP_UNSET_STATUS = 5;
+const int OP_REMOVE_ITEM = 6;
+const int OP_REWARD_XP = 7;
+const int OP_REWARD_CURRENCY = 8;
+const int OP_REWARD_ITEM = 9;
+const int OP_INTERMAP = 10;
+const int OP_MAPMOD = 11;
+const int OP_SOUNDFX = 12;
+const int OP_LOOT = 13;
+const int OP_MSG = 14;
+const int OP_SHAKYCAM = 15;
+const int OP_SAY_HIM = 16;
+const int OP_SAY_HER = 17;
+const int OP_SAY_YOU = 18;
+const int OP_QUEST_TEXT = 19;
+
+// layers changed by OP_MAPMOD
+const int MAPMOD_COLLISION = 0;
+const int MAPMOD_OBJECT = 1;
+const int MAPMOD_BACKGROUND = 2;
+
+// run modes
+const int SCRIPT_CHECK = 0;  // requirements only, stop at the first other op
+const int SCRIPT_RUN = 1;    // requirements and effects
+const int SCRIPT_RESUME = 2; // effects only; requirements were checked before
+
+const int SCRIPT_FAILED = -1;
+
+struct Event_Op {
+	int op;
+	int s; // status atom, string index or MAPMOD layer, depending on op
+	int x;
+	int y;
+	int z;
+};
+
+class EventScript;
+
+class EventHandler {
+public:
+	virtual ~EventHandler() {}
+
+	// handle an op the interpreter doesn't know
+	// return true to stop the script at this op
+	virtual bool eventOp(const Event_Op &op, EventScript *script) = 0;
+};
+
+class EventScript {
+private:
+	vector<Event_Op> ops;
+	vector<int> entries;
+	vector<string> strings;
+	
+	int addString(const string &s);
+	
+public:
+	EventScript();
+	void clear();
+	
+	// compiling
+	int beginProgram();
+	void add(const Event_Component &ec);
+	
+	int run(int pc, int mode, CampaignManager *camp, EventHandler *handler);
+	
+	int entry(int program);
+	int programCount() { return entries.size(); }
+	const Event_Op &getOp(int pc) { return ops[pc]; }
+	const string &getString(int index) { return strings[index]; }
+};
+
+#endif
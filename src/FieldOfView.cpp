@@ -0,0 +1,154 @@
+/**
+ * class FieldOfView
+ *
+ * Which tiles the hero can see, shared by every line of sight test against the hero.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "FieldOfView.h"
+
+// octant transforms for castLight
+const int FOV_XX[8] = {1, 0, 0,-1,-1, 0, 0, 1};
+const int FOV_XY[8] = {0, 1,-1, 0, 0,-1, 1, 0};
+const int FOV_YX[8] = {0, 1, 1, 0, 0,-1,-1, 0};
+const int FOV_YY[8] = {1, 0, 0, 1,-1, 0, 0,-1};
+
+FieldOfView::FieldOfView() {
+	collider = NULL;
+	map_size.x = map_size.y = 0;
+	center.x = center.y = -1;
+	radius = 0;
+	valid = false;
+	generation = 0;
+}
+
+/**
+ * Size the field for the collider's current map
+ */
+void FieldOfView::init(MapCollision *_collider) {
+	collider = _collider;
+	map_size = collider->map_size;
+	stamp.assign(map_size.x * map_size.y, 0);
+	generation = 0;
+	valid = false;
+}
+
+/**
+ * The collision layer changed; recompute on the next update
+ */
+void FieldOfView::invalidate() {
+	valid = false;
+}
+
+/**
+ * Follow the hero.  Nothing is done until the hero enters another tile.
+ *
+ * @param hero_pos Hero position in map units
+ * @param range    Furthest distance anyone needs to see the hero from, in map units
+ */
+void FieldOfView::update(Point hero_pos, int range) {
+	if (collider == NULL) return;
+
+	Point tile;
+	tile.x = hero_pos.x >> TILE_SHIFT;
+	tile.y = hero_pos.y >> TILE_SHIFT;
+	int tiles = range / UNITS_PER_TILE + 2;
+	if (valid && tile.x == center.x && tile.y == center.y && tiles == radius) return;
+
+	center = tile;
+	radius = tiles;
+	compute();
+	valid = true;
+}
+
+void FieldOfView::mark(int x, int y) {
+	if (collider->outsideMap(x, y)) return;
+	stamp[y * map_size.x + x] = generation;
+}
+
+void FieldOfView::compute() {
+	generation++;
+	if (collider->outsideMap(center.x, center.y)) return;
+
+	mark(center.x, center.y);
+	for (int oct=0; oct<8; oct++) {
+		castLight(1, 1.0f, 0.0f, FOV_XX[oct], FOV_XY[oct], FOV_YX[oct], FOV_YY[oct]);
+	}
+}
+
+/**
+ * Recursive shadowcasting over one octant.
+ * Scans rows outward from the center between the start and end slopes;
+ * each run of blocking tiles splits the light into a narrower scan.
+ */
+void FieldOfView::castLight(int row, float start, float end, int xx, int xy, int yx, int yy) {
+	if (start < end) return;
+
+	int radius_squared = radius * radius;
+	float new_start = 0.0f;
+
+	for (int j=row; j<=radius; j++) {
+		int dx = -j-1;
+		int dy = -j;
+		bool blocked = false;
+
+		while (dx <= 0) {
+			dx++;
+			int x = center.x + dx * xx + dy * xy;
+			int y = center.y + dx * yx + dy * yy;
+			float left_slope = (dx - 0.5f) / (dy + 0.5f);
+			float right_slope = (dx + 0.5f) / (dy - 0.5f);
+
+			if (start < right_slope) continue;
+			if (end > left_slope) break;
+
+			// a tile is seen when the light reaches its center
+			float center_slope = (float)dx / (float)dy;
+			if (dx*dx + dy*dy < radius_squared && center_slope <= start && center_slope >= end) mark(x, y);
+
+			bool wall = collider->tile_blocks(x, y, CHECK_SIGHT);
+			if (blocked) {
+				if (wall) {
+					new_start = right_slope;
+					continue;
+				}
+				blocked = false;
+				start = new_start;
+			}
+			else if (wall && j < radius) {
+				blocked = true;
+				castLight(j+1, start, left_slope, xx, xy, yx, yy);
+				new_start = right_slope;
+			}
+		}
+		if (blocked) break;
+	}
+}
+
+/**
+ * Can target be seen from viewer?
+ * Only answers when viewer stands in the hero's tile and target is within the field.
+ *
+ * @return false if the field can't answer; use a line check instead
+ */
+bool FieldOfView::lookup(Point viewer, Point target, bool &visible) {
+	if (!valid) return false;
+	if ((viewer.x >> TILE_SHIFT) != center.x || (viewer.y >> TILE_SHIFT) != center.y) return false;
+
+	int x = target.x >> TILE_SHIFT;
+	int y = target.y >> TILE_SHIFT;
+	int dx = x - center.x;
+	int dy = y - center.y;
+	if (dx*dx + dy*dy >= radius * radius) return false;
+
+	// shadowcasting lights the walls bounding the field, but a line check
+	// ending inside a wall is blocked by it
+	if (collider->tile_blocks(x, y, CHECK_SIGHT)) visible = false;
+	else visible = (stamp[y * map_size.x + x] == generation);
+	return true;
+}
+
+FieldOfView::~FieldOfView() {
+}
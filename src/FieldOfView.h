@@ -0,0 +1,54 @@
+/**
+ * class FieldOfView
+ *
+ * Which tiles the hero can see, shared by every line of sight test against the hero.
+ *
+ * Recursive shadowcasting from the hero's tile over the sight-blocking tiles
+ * marks every visible tile out to a radius.  The field only changes when the
+ * hero enters another tile or the collision layer changes, and enemies then
+ * answer "can I see the hero" with a table lookup instead of a ray march.
+ *
+ * Visibility is decided per tile, so it can differ from an exact
+ * line_of_sight between two points near the corner of a wall.  Tiles that
+ * block sight are never visible, as a line_of_sight into them is blocked.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef FIELD_OF_VIEW_H
+#define FIELD_OF_VIEW_H
+
+#include <vector>
+#include "Utils.h"
+#include "MapCollision.h"
+
+using namespace std;
+
+class FieldOfView {
+private:
+	MapCollision *collider;
+	Point map_size;
+	Point center; // hero tile
+	int radius; // in tiles
+	bool valid;
+
+	// a tile is visible when its stamp matches the current generation
+	int generation;
+	vector<int> stamp;
+
+	void mark(int x, int y);
+	void castLight(int row, float start, float end, int xx, int xy, int yx, int yy);
+	void compute();
+
+public:
+	FieldOfView();
+	~FieldOfView();
+
+	void init(MapCollision *_collider);
+	void invalidate();
+	void update(Point hero_pos, int range);
+	bool lookup(Point viewer, Point target, bool &visible);
+};
+
+#endif
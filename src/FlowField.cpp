@@ -0,0 +1,213 @@
+/**
+ * class FlowField
+ *
+ * Shortest walking directions towards the hero, shared by all enemies.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "FlowField.h"
+#include "PathFinder.h"
+
+// neighbour offsets; direction d and (d+4)%8 are opposites
+const int FLOW_DX[8] = {-1,-1, 0, 1, 1, 1, 0,-1};
+const int FLOW_DY[8] = { 0, 1, 1, 1, 0,-1,-1,-1};
+
+FlowField::FlowField() {
+	collider = NULL;
+	map_size.x = map_size.y = 0;
+	center.x = center.y = -1;
+	range = 0;
+	valid = false;
+	generation = 0;
+}
+
+/**
+ * Size the field for the collider's current map
+ */
+void FlowField::init(MapCollision *_collider) {
+	collider = _collider;
+	map_size = collider->map_size;
+	int count = map_size.x * map_size.y;
+	stamp.assign(count, 0);
+	cost.assign(count, 0);
+	step.assign(count, 0);
+	generation = 0;
+	valid = false;
+}
+
+/**
+ * The collision layer changed; rebuild on the next update
+ */
+void FlowField::invalidate() {
+	valid = false;
+}
+
+bool FlowField::walkable(int x, int y) {
+	return !collider->tile_blocks(x, y, CHECK_MOVEMENT);
+}
+
+/**
+ * Follow the hero.  Nothing is done until the hero enters another tile.
+ *
+ * @param hero_pos Hero position in map units
+ * @param _range   How far from the hero enemies may still be pursuing, in map units
+ */
+void FlowField::update(Point hero_pos, int _range) {
+	if (collider == NULL) return;
+
+	Point tile;
+	tile.x = hero_pos.x >> TILE_SHIFT;
+	tile.y = hero_pos.y >> TILE_SHIFT;
+	if (valid && tile.x == center.x && tile.y == center.y && _range == range) return;
+
+	// the hero moved within the same field: keep what is still right
+	if (valid && _range == range && !collider->outsideMap(tile.x, tile.y) &&
+	    stamp[tile.y * map_size.x + tile.x] == generation) {
+		repair(tile);
+		return;
+	}
+
+	center = tile;
+	range = _range;
+	compute();
+	valid = true;
+}
+
+void FlowField::compute() {
+	generation++;
+	if (!walkable(center.x, center.y)) return;
+
+	priority_queue<Flow_Open, vector<Flow_Open>, greater<Flow_Open> > open;
+
+	int start = center.y * map_size.x + center.x;
+	stamp[start] = generation;
+	cost[start] = 0;
+	open.push(Flow_Open(0, start));
+	search(open);
+}
+
+/**
+ * Move the field's center to a tile that is already in the field.
+ *
+ * The tiles whose step leads through the new center (its subtree) already
+ * point along a shortest way there, and their distance just drops by the new
+ * center's old cost.  They are carried over as they are, and the search only
+ * continues from the edge of that subtree into the rest of the field.
+ */
+void FlowField::repair(Point tile) {
+	int old_generation = generation;
+	generation++;
+
+	int start = tile.y * map_size.x + tile.x;
+	int old_start = center.y * map_size.x + center.x; // has no step of its own
+	int offset = cost[start];
+	center = tile;
+
+	// walk the subtree from the new center, following steps backwards
+	reused.clear();
+	reused.push_back(start);
+	stamp[start] = generation;
+	cost[start] = 0;
+	for (unsigned k=0; k<reused.size(); k++) {
+		int cur = reused[k];
+		int x = cur % map_size.x;
+		int y = cur / map_size.x;
+		for (int d=0; d<8; d++) {
+			int nx = x + FLOW_DX[d];
+			int ny = y + FLOW_DY[d];
+			if (collider->outsideMap(nx, ny)) continue;
+
+			int next = ny * map_size.x + nx;
+			if (next == old_start || stamp[next] != old_generation || step[next] != (d + 4) % 8) continue;
+			stamp[next] = generation;
+			cost[next] -= offset;
+			reused.push_back(next);
+		}
+	}
+
+	// carried-over tiles are final; search on from the ones at the subtree's edge
+	priority_queue<Flow_Open, vector<Flow_Open>, greater<Flow_Open> > open;
+	for (unsigned k=0; k<reused.size(); k++) {
+		int cur = reused[k];
+		int x = cur % map_size.x;
+		int y = cur / map_size.x;
+		for (int d=0; d<8; d++) {
+			int nx = x + FLOW_DX[d];
+			int ny = y + FLOW_DY[d];
+			if (collider->outsideMap(nx, ny)) continue;
+			if (stamp[ny * map_size.x + nx] != generation) {
+				open.push(Flow_Open(cost[cur], cur));
+				break;
+			}
+		}
+	}
+	search(open);
+}
+
+/**
+ * Dijkstra from the tiles in open, up to the range limit
+ */
+void FlowField::search(priority_queue<Flow_Open, vector<Flow_Open>, greater<Flow_Open> > &open) {
+	int limit = range * PATH_COST_STRAIGHT / UNITS_PER_TILE;
+
+	while (!open.empty()) {
+		int c = open.top().first;
+		int cur = open.top().second;
+		open.pop();
+		if (c > cost[cur]) continue;
+
+		int x = cur % map_size.x;
+		int y = cur / map_size.x;
+
+		for (int d=0; d<8; d++) {
+			int nx = x + FLOW_DX[d];
+			int ny = y + FLOW_DY[d];
+			if (!walkable(nx, ny)) continue;
+
+			int next_cost = c + PATH_COST_STRAIGHT;
+			if (FLOW_DX[d] != 0 && FLOW_DY[d] != 0) {
+				// don't cut corners
+				if (!walkable(nx, y) || !walkable(x, ny)) continue;
+				next_cost = c + PATH_COST_DIAGONAL;
+			}
+			if (next_cost > limit) continue;
+
+			int next = ny * map_size.x + nx;
+			if (stamp[next] == generation && cost[next] <= next_cost) continue;
+			stamp[next] = generation;
+			cost[next] = next_cost;
+			step[next] = (d + 4) % 8;
+			open.push(Flow_Open(next_cost, next));
+		}
+	}
+}
+
+/**
+ * Where to walk from pos when heading for target.
+ * Only answers when target is in the hero's tile and pos is within the field.
+ *
+ * @param next Receives the center of the next tile, in map units
+ * @return false if the field can't help; steer some other way
+ */
+bool FlowField::nextStep(Point pos, Point target, Point &next) {
+	if (!valid) return false;
+	if ((target.x >> TILE_SHIFT) != center.x || (target.y >> TILE_SHIFT) != center.y) return false;
+
+	int x = pos.x >> TILE_SHIFT;
+	int y = pos.y >> TILE_SHIFT;
+	if (collider->outsideMap(x, y)) return false;
+	if (x == center.x && y == center.y) return false;
+
+	int index = y * map_size.x + x;
+	if (stamp[index] != generation) return false;
+
+	int d = step[index];
+	next.x = (x + FLOW_DX[d]) * UNITS_PER_TILE + UNITS_PER_TILE/2;
+	next.y = (y + FLOW_DY[d]) * UNITS_PER_TILE + UNITS_PER_TILE/2;
+	return true;
+}
+
+FlowField::~FlowField() {
+}
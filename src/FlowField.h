@@ -0,0 +1,62 @@
+/**
+ * class FlowField
+ *
+ * Shortest walking directions towards the hero, shared by all enemies.
+ *
+ * A Dijkstra search spreads out from the hero's tile over the collision layer
+ * and stores, for every tile it reaches, the neighbouring tile one step closer
+ * to the hero.  Any number of enemies can then read their next step in
+ * constant time.  The field is only updated when the hero enters another tile,
+ * and the search stops at the range enemies pursue from.
+ *
+ * When the hero steps to a tile that was already in the field, every tile
+ * whose way to the hero went through that tile keeps its direction, and only
+ * the rest of the field is searched again.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <queue>
+#include <vector>
+#include "Utils.h"
+#include "MapCollision.h"
+
+using namespace std;
+
+typedef pair<int, int> Flow_Open; // cost, tile index
+
+class FlowField {
+private:
+	MapCollision *collider;
+	Point map_size;
+	Point center; // hero tile
+	int range; // search limit in map units
+	bool valid;
+
+	// per tile; entries are only current when their stamp matches generation
+	int generation;
+	vector<int> stamp;
+	vector<int> cost;
+	vector<unsigned char> step; // direction towards the hero, index into the step tables
+
+	bool walkable(int x, int y);
+	void compute();
+	void repair(Point tile);
+	void search(priority_queue<Flow_Open, vector<Flow_Open>, greater<Flow_Open> > &open);
+	vector<int> reused; // scratch for repair()
+
+public:
+	FlowField();
+	~FlowField();
+
+	void init(MapCollision *_collider);
+	void invalidate();
+	void update(Point hero_pos, int _range);
+	bool nextStep(Point pos, Point target, Point &next);
+};
+
+#endif
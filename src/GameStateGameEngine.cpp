@@ -140,6 +140,7 @@ void GameStateGameEngine::checkTeleport() {
 			map->cam.x = pc->stats.pos.x = pc->stats.teleport_destination.x;
 			map->cam.y = pc->stats.pos.y = pc->stats.teleport_destination.y;		
 		}
+		pc->move_to_target = false;
 		
 		// process intermap teleport
 		if (map->teleportation && map->teleport_mapname != "") {
@@ -371,10 +372,15 @@ void GameStateGameEngine::render() {
 
 	r[renderableCount++] = pc->getRender(); // Avatar
 	
-	for (int i=0; i<enemies->enemy_count; i++) { // Enemies
+	// Enemies, only those on screen so a crowded map can't overflow the list
+	enemies->onScreen(map->cam, visible_enemies);
+	for (unsigned k=0; k<visible_enemies.size(); k++) {
+		int i = visible_enemies[k];
+		if (renderableCount + 2 > max_renderables) break;
 		r[renderableCount++] = enemies->getRender(i);
 		if (enemies->enemies[i]->stats.shield_hp > 0) {
 			r[renderableCount] = enemies->enemies[i]->stats.getEffectRender(STAT_EFFECT_SHIELD);
+			r[renderableCount].map_pos = enemies->getPos(i);
 			r[renderableCount++].sprite = powers->gfx[powers->powers[POWER_SHIELD].gfx_index]; // TODO: parameter
 		}
 	}
@@ -388,7 +394,7 @@ void GameStateGameEngine::render() {
 	}
 	
 	for (int i=0; i<hazards->hazard_count; i++) { // Hazards
-		if (hazards->h[i]->rendered && hazards->h[i]->delay_frames == 0) {
+		if (hazards->isVisible(i)) {
 			r[renderableCount++] = hazards->getRender(i);
 		}
 	}
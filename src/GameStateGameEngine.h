@@ -29,6 +29,8 @@
 #include "QuestLog.h"
 #include "GameState.h"
 
+const int max_renderables = 1024;
+
 class GameStateGameEngine : public GameState {
 private:
 	SDL_Surface *screen;
@@ -37,8 +39,9 @@ private:
 	Avatar *pc;
 	MapIso *map;
 	Enemy *enemy;
-	Renderable r[1024];
+	Renderable r[max_renderables];
 	int renderableCount;
+	vector<int> visible_enemies;
 	HazardManager *hazards;
 	EnemyManager *enemies;
 	FontEngine *font;
@@ -13,6 +13,7 @@
 Hazard::Hazard() {
 	src_stats = NULL;
 	sprites = NULL;
+	atlas = NULL;
 	speed.x = 0.0;
 	speed.y = 0.0;
 	direction = 0;
@@ -45,45 +46,8 @@ Hazard::Hazard() {
 	trait_armor_penetration = false;
 	trait_crits_impaired = 0;
 	trait_elemental = -1;
-	remove_now = false;
 	post_power = -1;
 	wall_power = -1;
-	hit_wall = false;
 	equipment_modified = false;
 	base_speed = 0;
 }
-
-void Hazard::setCollision(MapCollision *_collider) {
-	collider = _collider;
-}
-
-void Hazard::logic() {
-	
-	// if the hazard is on delay, take no action
-	if (delay_frames > 0) {
-		delay_frames--;
-		return;
-	}
-	
-	// handle tickers
-	if (lifespan > 0) lifespan--;
-	frame++;
-	if (frame == frame_loop) frame=0;
-	
-	// handle movement
-	if (!(round(speed.x) == 0 && round(speed.y) == 0)) {
-		pos.x += speed.x;
-		pos.y += speed.y;
-		
-		// very simplified collider, could skim around corners
-		// or even pass through thin walls if speed > tilesize
-		if (collider->is_wall(round(pos.x), round(pos.y))) {
-			lifespan = 0;
-			hit_wall = true;
-			
-			if (collider->outsideMap(round(pos.x) >> TILE_SHIFT, round(pos.y) >> TILE_SHIFT))
-				remove_now = true;
-		}
-	}
-
-}
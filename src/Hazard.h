@@ -4,6 +4,10 @@
  * Stand-alone object that can harm the hero or creatures
  * These are generated whenever something makes any attack
  *
+ * pos, speed, lifespan, frame, delay_frames and active are starting values.
+ * Once HazardManager takes a hazard it keeps the live values in its own
+ * columns and updates them there.
+ *
  * @author Clint Bellanger
  * @license GPL
  */
@@ -15,20 +19,17 @@
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
-#include "MapCollision.h"
 #include "StatBlock.h"
+#include "SpriteAtlas.h"
 
 class Hazard {
-private:
-	MapCollision *collider;
 public:
 	Hazard();
 	
 	StatBlock *src_stats;
 
 	SDL_Surface *sprites;
-	void setCollision(MapCollision *_collider);
-	void logic();
+	SpriteAtlas *atlas; // packed frames, used instead of sprites when set
 
 	//int enemyIndex; //don't know what this does... doesn't look like it's ever used.
 	
@@ -64,9 +65,6 @@ public:
 	bool multitarget;
 	bool active;
 	
-	bool remove_now;
-	bool hit_wall;
-	
 	// after effects of various powers
 	int stun_duration;
 	int immobilize_duration;
@@ -20,27 +20,23 @@ void HazardManager::logic() {
 
 	// remove all hazards with lifespan 0.  Most hazards still display their last frame.
 	for (int i=hazard_count-1; i>=0; i--) {
-		if (h[i]->lifespan == 0)
+		if (hot_lifespan[i] == 0)
 			expire(i);
 	}
 	
 	checkNewHazards();
 	
 	// handle single-frame transforms
+	update();
+	
 	for (int i=hazard_count-1; i>=0; i--) {
-		h[i]->logic();
-		
-		// remove all hazards that need to die immediately (e.g. exit the map)
-		if (h[i]->remove_now)
-			expire(i);
-		
 		
 		// if a moving hazard hits a wall, check for an after-effect
-		if (h[i]->hit_wall && h[i]->wall_power >= 0) {
+		if ((hot_flags[i] & HAZARD_HIT_WALL) && h[i]->wall_power >= 0) {
 			Point pt;
 			StatBlock sb;
-			sb.pos.x = (int)(h[i]->pos.x);
-			sb.pos.y = (int)(h[i]->pos.y);
+			sb.pos.x = (int)(hot_pos[i].x);
+			sb.pos.y = (int)(hot_pos[i].y);
 			
 			if (powers->powers[h[i]->wall_power].directional) {
 				pt = round(calcVector(sb.pos,h[i]->direction,64));
@@ -49,42 +45,71 @@ void HazardManager::logic() {
 			powers->activate(h[i]->wall_power, &sb, pt);
 		}
 		
+		// remove all hazards that need to die immediately (e.g. exit the map)
+		// hazards after i were already handled, so the one moved into i is done too
+		if (hot_flags[i] & HAZARD_REMOVE_NOW)
+			expire(i);
 	}
 	
 	bool hit;
+	float t;
 	
 	// handle collisions
+	// moving hazards are tested along their whole move this frame, not just where they stopped
 	for (int i=0; i<hazard_count; i++) {
-		if (h[i]->active && h[i]->delay_frames==0 && (h[i]->active_frame == -1 || h[i]->active_frame == h[i]->frame)) {
+		if ((hot_flags[i] & HAZARD_ACTIVE) && hot_delay[i]==0 && (h[i]->active_frame == -1 || h[i]->active_frame == hot_frame[i])) {
+			Point from = round(hot_from[i]);
+			Point to = round(hot_pos[i]);
 	
 			// process hazards that can hurt enemies
 			if (h[i]->src_stats->hero) { //there are no NEUTRAL DAMAGE SOURCES yet
-				for (int eindex = 0; eindex < enemies->enemy_count; eindex++) {
-			
-					// only check living enemies
-					if (enemies->enemies[eindex]->stats.hp > 0 && h[i]->active) {
-						if (isWithin(round(h[i]->pos), h[i]->radius, enemies->enemies[eindex]->stats.pos)) {
-							// hit!
-							hit = enemies->enemies[eindex]->takeHit(*h[i]);
-							if (!h[i]->multitarget && hit) {
-								h[i]->active = false;
-								if (!h[i]->complete_animation) h[i]->lifespan = 0;
-							}
-						}
+				// only enemies in nearby grid cells can be in range
+				if (from.x == to.x && from.y == to.y) {
+					enemies->grid.query(to, h[i]->radius, targets);
+				}
+				else {
+					SDL_Rect area;
+					area.x = min(from.x, to.x) - h[i]->radius;
+					area.y = min(from.y, to.y) - h[i]->radius;
+					area.w = abs(to.x - from.x) + h[i]->radius * 2;
+					area.h = abs(to.y - from.y) + h[i]->radius * 2;
+					enemies->grid.query(area, targets);
+				}
+				
+				// only check living enemies
+				touched.clear();
+				for (unsigned k = 0; k < targets.size(); k++) {
+					int eindex = targets[k];
+					if (enemies->isAlive(eindex) && isWithin(from, to, h[i]->radius, enemies->getPos(eindex), t)) {
+						touched.push_back(make_pair(t, eindex));
 					}
+				}
 				
+				// the first enemy in the hazard's way takes the hit
+				sort(touched.begin(), touched.end());
+				for (unsigned k = 0; k < touched.size() && (hot_flags[i] & HAZARD_ACTIVE); k++) {
+					// hit!
+					hit = enemies->hitEnemy(touched[k].second, *h[i]);
+					if (!h[i]->multitarget && hit) {
+						hot_flags[i] &= ~HAZARD_ACTIVE;
+						if (!h[i]->complete_animation) hot_lifespan[i] = 0;
+					}
 				}
 			}
 		
 			// process hazards that can hurt the hero
 			if (!h[i]->src_stats->hero) {
-				if (hero->stats.hp > 0 && h[i]->active) {
-					if (isWithin(round(h[i]->pos), h[i]->radius, hero->stats.pos)) {
+				if (hero->stats.hp > 0 && (hot_flags[i] & HAZARD_ACTIVE)) {
+					if (isWithin(from, to, h[i]->radius, hero->stats.pos, t)) {
 						// hit!
+						// an hp steal goes back to the attacker's row of the enemy columns
+						Enemy *src = enemies->sourceOf(h[i]->src_stats);
+						if (src != NULL) src->lendStats();
 						hit = hero->takeHit(*h[i]);
+						if (src != NULL) src->returnStats();
 						if (!h[i]->multitarget && hit) {
-							h[i]->active = false;
-							if (!h[i]->complete_animation) h[i]->lifespan = 0;
+							hot_flags[i] &= ~HAZARD_ACTIVE;
+							if (!h[i]->complete_animation) hot_lifespan[i] = 0;
 						}
 					}
 				}
@@ -94,6 +119,81 @@ void HazardManager::logic() {
 	}
 }
 
+/**
+ * Advance every hazard one frame: delay, lifespan, animation and movement,
+ * then test the moved ones against the collision layer in one batch
+ */
+void HazardManager::update() {
+	int n = hazard_count;
+	ticked.resize(n);
+	
+	// hazards on delay take no action
+	for (int i=0; i<n; i++) {
+		Uint8 tick = (hot_delay[i] == 0);
+		ticked[i] = tick;
+		hot_delay[i] -= !tick;
+		hot_lifespan[i] -= tick & (hot_lifespan[i] > 0);
+		
+		int frame = hot_frame[i] + tick;
+		hot_frame[i] = (tick && frame == hot_frame_loop[i]) ? 0 : frame;
+	}
+	
+	for (int i=0; i<n; i++) {
+		float step = (float)(ticked[i] & hot_flags[i] & HAZARD_MOVING);
+		hot_from[i] = hot_pos[i];
+		hot_pos[i].x += hot_speed[i].x * step;
+		hot_pos[i].y += hot_speed[i].y * step;
+	}
+	
+	// follow each move tile by tile, so fast hazards can't pass through thin walls
+	probe_ids.clear();
+	probe_from.clear();
+	probe_to.clear();
+	for (int i=0; i<n; i++) {
+		if (ticked[i] & hot_flags[i] & HAZARD_MOVING) {
+			probe_ids.push_back(i);
+			probe_from.push_back(round(hot_from[i]));
+			probe_to.push_back(round(hot_pos[i]));
+		}
+	}
+	collider->sweep_walls(probe_from, probe_to, probe_result, probe_hit);
+	
+	for (unsigned k=0; k<probe_ids.size(); k++) {
+		if (probe_result[k] == PROBE_OPEN) continue;
+		int i = probe_ids[k];
+		
+		// stop where the hazard met the wall
+		if (probe_hit[k].x != probe_to[k].x || probe_hit[k].y != probe_to[k].y) {
+			hot_pos[i].x = (float)probe_hit[k].x;
+			hot_pos[i].y = (float)probe_hit[k].y;
+		}
+		hot_lifespan[i] = 0;
+		hot_flags[i] |= HAZARD_HIT_WALL;
+		if (probe_result[k] == PROBE_OUTSIDE) hot_flags[i] |= HAZARD_REMOVE_NOW;
+	}
+}
+
+/**
+ * Take ownership of a new hazard and copy its starting values into the columns
+ */
+void HazardManager::add(Hazard *haz) {
+	h.push_back(haz);
+	hot_pos.push_back(haz->pos);
+	hot_from.push_back(haz->pos);
+	hot_speed.push_back(haz->speed);
+	hot_lifespan.push_back(haz->lifespan);
+	hot_frame.push_back(haz->frame);
+	hot_frame_loop.push_back(haz->frame_loop);
+	hot_delay.push_back(haz->delay_frames);
+	
+	Uint8 flags = 0;
+	if (!(round(haz->speed.x) == 0 && round(haz->speed.y) == 0)) flags |= HAZARD_MOVING;
+	if (haz->active) flags |= HAZARD_ACTIVE;
+	hot_flags.push_back(flags);
+	
+	hazard_count++;
+}
+
 /**
  * Look for hazards generated this frame
  * TODO: all these hazards will originate from PowerManager instead
@@ -106,24 +206,20 @@ void HazardManager::checkNewHazards() {
 	while (!powers->hazards.empty()) {
 		new_haz = powers->hazards.front();		
 		powers->hazards.pop();		
-		new_haz->setCollision(collider);
-
-		h[hazard_count] = new_haz;
-		hazard_count++;
+		add(new_haz);
 	}
 
 	// check hero hazards
 	if (hero->haz != NULL) {
-		h[hazard_count] = hero->haz;
-		hazard_count++;
+		add(hero->haz);
 		hero->haz = NULL;
 	}
 	
 	// check monster hazards
-	for (int eindex = 0; eindex < enemies->enemy_count; eindex++) {
+	for (unsigned k = 0; k < enemies->awake.size(); k++) {
+		int eindex = enemies->awake[k];
 		if (enemies->enemies[eindex]->haz != NULL) {
-			h[hazard_count] = enemies->enemies[eindex]->haz;
-			hazard_count++;
+			add(enemies->enemies[eindex]->haz);
 			enemies->enemies[eindex]->haz = NULL;
 		}
 	}
@@ -132,10 +228,27 @@ void HazardManager::checkNewHazards() {
 void HazardManager::expire(int index) {
 	// TODO: assert this instead?
 	if (index >= 0 && index < hazard_count) {
-		delete(h[index]);
-		for (int i=index; i<hazard_count-1; i++) {
-			h[i] = h[i+1];
-		}
+		int last = hazard_count-1;
+		powers->hazard_pool.release(h[index]);
+		h[index] = h[last];
+		hot_pos[index] = hot_pos[last];
+		hot_from[index] = hot_from[last];
+		hot_speed[index] = hot_speed[last];
+		hot_lifespan[index] = hot_lifespan[last];
+		hot_frame[index] = hot_frame[last];
+		hot_frame_loop[index] = hot_frame_loop[last];
+		hot_delay[index] = hot_delay[last];
+		hot_flags[index] = hot_flags[last];
+		
+		h.pop_back();
+		hot_pos.pop_back();
+		hot_from.pop_back();
+		hot_speed.pop_back();
+		hot_lifespan.pop_back();
+		hot_frame.pop_back();
+		hot_frame_loop.pop_back();
+		hot_delay.pop_back();
+		hot_flags.pop_back();
 		hazard_count--;
 	}
 }
@@ -144,7 +257,21 @@ void HazardManager::expire(int index) {
  * Reset all hazards and get new collision object
  */
 void HazardManager::handleNewMap(MapCollision *_collider) {
+
+	// hazards from the old map, including any not collected yet
+	h.clear();
+	hot_pos.clear();
+	hot_from.clear();
+	hot_speed.clear();
+	hot_lifespan.clear();
+	hot_frame.clear();
+	hot_frame_loop.clear();
+	hot_delay.clear();
+	hot_flags.clear();
 	hazard_count = 0;
+	while (!powers->hazards.empty()) powers->hazards.pop();
+	powers->hazard_pool.releaseAll();
+	
 	collider = _collider;
 }
 
@@ -156,10 +283,10 @@ void HazardManager::handleNewMap(MapCollision *_collider) {
 Renderable HazardManager::getRender(int haz_id) {
 
 	Renderable r;
-	r.map_pos.x = round(h[haz_id]->pos.x);
-	r.map_pos.y = round(h[haz_id]->pos.y);
+	r.map_pos.x = round(hot_pos[haz_id].x);
+	r.map_pos.y = round(hot_pos[haz_id].y);
 	r.sprite = h[haz_id]->sprites;
-	r.src.x = h[haz_id]->frame_size.x * (h[haz_id]->frame / h[haz_id]->frame_duration);
+	r.src.x = h[haz_id]->frame_size.x * (hot_frame[haz_id] / h[haz_id]->frame_duration);
 	r.src.w = h[haz_id]->frame_size.x;
 	r.src.h = h[haz_id]->frame_size.y;
 	r.offset.x = h[haz_id]->frame_offset.x;
@@ -172,12 +299,18 @@ Renderable HazardManager::getRender(int haz_id) {
 		r.src.y = h[haz_id]->frame_size.y * h[haz_id]->visual_option;
 	else
 		r.src.y = 0;
+
+	// look up the trimmed frame in the packed sheet
+	if (h[haz_id]->atlas != NULL)
+		h[haz_id]->atlas->apply(r);
 	
 	return r;
 }
 
+bool HazardManager::isVisible(int haz_id) {
+	return h[haz_id]->rendered && hot_delay[haz_id] == 0;
+}
+
 HazardManager::~HazardManager() {
-	for (int i=0; i<hazard_count; i++) {
-		delete h[i];
-	}
+	// the hazards belong to the pool in PowerManager
 }
@@ -10,6 +10,9 @@
 #ifndef HAZARD_MANAGER_H
 #define HAZARD_MANAGER_H
 
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include "Avatar.h"
 #include "EnemyManager.h"
 #include "Utils.h"
@@ -17,12 +20,44 @@
 #include "MapCollision.h"
 #include "PowerManager.h"
 
+// hot_flags bits
+const Uint8 HAZARD_MOVING = 1; // speed rounds to a nonzero step
+const Uint8 HAZARD_ACTIVE = 2; // can still hit something
+const Uint8 HAZARD_HIT_WALL = 4;
+const Uint8 HAZARD_REMOVE_NOW = 8; // left the map
+
 class HazardManager {
 private:
 	Avatar *hero;
 	EnemyManager *enemies;
 	MapCollision *collider;
 	PowerManager *powers;
+	vector<int> targets; // enemies near the hazard being checked
+	
+	// hot fields, one column per field in the same order as h,
+	// so the per-frame update runs over plain arrays instead of Hazard objects
+	vector<FPoint> hot_pos;
+	vector<FPoint> hot_from; // hot_pos before this frame's move
+	vector<FPoint> hot_speed;
+	vector<int> hot_lifespan;
+	vector<int> hot_frame;
+	vector<int> hot_frame_loop;
+	vector<int> hot_delay;
+	vector<Uint8> hot_flags;
+	void add(Hazard *haz);
+	void update();
+	
+	// scratch space for update()
+	vector<Uint8> ticked;
+	vector<int> probe_ids;
+	vector<Point> probe_from;
+	vector<Point> probe_to;
+	vector<char> probe_result;
+	vector<Point> probe_hit;
+	
+	// targets the hazard being checked passes over, by how far along its move
+	vector< pair<float, int> > touched;
+	
 public:
 	HazardManager(PowerManager *_powers, Avatar *_hero, EnemyManager *_enemies);
 	~HazardManager();
@@ -31,9 +66,10 @@ public:
 	void checkNewHazards();
 	void handleNewMap(MapCollision *_collider);
 	Renderable getRender(int haz_id);
+	bool isVisible(int haz_id);
 	
 	int hazard_count;
-	Hazard *h[256];
+	vector<Hazard*> h; // unordered; expire() moves the last hazard into the gap
 };
 
 #endif
@@ -0,0 +1,66 @@
+/**
+ * class HazardPool
+ *
+ * Fixed-size blocks of Hazard objects for PowerManager to hand out.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "HazardPool.h"
+
+HazardPool::HazardPool() {
+	live = 0;
+	high_water = 0;
+}
+
+void HazardPool::addBlock() {
+	Hazard *block = static_cast<Hazard*>(operator new(HAZARD_BLOCK_SIZE * sizeof(Hazard)));
+	blocks.push_back(block);
+	
+	// hand out the start of the block first
+	for (int i=HAZARD_BLOCK_SIZE-1; i>=0; i--) {
+		free_slots.push_back(block + i);
+	}
+}
+
+/**
+ * A freshly constructed hazard
+ */
+Hazard *HazardPool::alloc() {
+	if (free_slots.empty()) addBlock();
+	
+	Hazard *slot = free_slots.back();
+	free_slots.pop_back();
+	
+	live++;
+	if (live > high_water) high_water = live;
+	
+	return new(slot) Hazard();
+}
+
+void HazardPool::release(Hazard *haz) {
+	if (haz == NULL) return;
+	free_slots.push_back(haz);
+	live--;
+}
+
+/**
+ * Return every slot at once, e.g. on map change.
+ * Any hazard still held elsewhere is invalid afterwards.
+ */
+void HazardPool::releaseAll() {
+	free_slots.clear();
+	for (int b=blocks.size()-1; b>=0; b--) {
+		for (int i=HAZARD_BLOCK_SIZE-1; i>=0; i--) {
+			free_slots.push_back(blocks[b] + i);
+		}
+	}
+	live = 0;
+}
+
+HazardPool::~HazardPool() {
+	for (unsigned i=0; i<blocks.size(); i++) {
+		operator delete(blocks[i]);
+	}
+}
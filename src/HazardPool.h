@@ -0,0 +1,46 @@
+/**
+ * class HazardPool
+ *
+ * Fixed-size blocks of Hazard objects for PowerManager to hand out.
+ *
+ * Blocks are allocated as needed and kept until the pool is destroyed, so
+ * after the first big fight creating a hazard is popping a free slot.
+ * Hazards own no resources, so release() and releaseAll() only return
+ * slots to the free list.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef HAZARD_POOL_H
+#define HAZARD_POOL_H
+
+#include <new>
+#include <vector>
+#include "Hazard.h"
+
+using namespace std;
+
+const int HAZARD_BLOCK_SIZE = 64;
+
+class HazardPool {
+private:
+	vector<Hazard*> blocks;
+	vector<Hazard*> free_slots;
+	
+	void addBlock();
+
+public:
+	HazardPool();
+	~HazardPool();
+	Hazard *alloc();
+	void release(Hazard *haz);
+	void releaseAll();
+	
+	// counters
+	int live; // hazards handed out and not yet released
+	int high_water; // most hazards live at once since the pool was created
+	int capacity() { return blocks.size() * HAZARD_BLOCK_SIZE; }
+};
+
+#endif
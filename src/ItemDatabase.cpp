@@ -166,7 +166,7 @@ void ItemDatabase::load() {
 					else if (key == "rand_vendor")
 						items[id].rand_vendor = atoi(val.c_str());
 					else if (key == "pickup_status")
-						items[id].pickup_status = val;
+						items[id].pickup_status = atom(val);
 						
 				}
 			}
@@ -84,7 +84,7 @@ struct Item {
 	int max_quantity;     // max count per stack
 	int rand_loot;        // max amount appearing in a loot stack
 	int rand_vendor;      // max amount appearing in a vendor stack
-	string pickup_status; // when this item is picked up, set a campaign state (usually for quest items)
+	int pickup_status; // atom; when this item is picked up, set a campaign state (usually for quest items)
 	
 	Item() {
 		name = "";
@@ -111,7 +111,7 @@ struct Item {
 		max_quantity = 1;
 		rand_loot = 1;
 		rand_vendor = 1;
-		pickup_status = "";
+		pickup_status = ATOM_NONE;
 	}
 };
 
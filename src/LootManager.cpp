@@ -21,10 +21,12 @@ LootManager::LootManager(ItemDatabase *_items, MenuTooltip *_tip, EnemyManager *
 	animation_count = 0;
 	
 	for (int i=0; i<64; i++) {
-		flying_loot[i] = NULL;
 		animation_id[i] = "";
 	}
 	
+	frame_size.x = 64;
+	frame_size.y = 128;
+	
 	loot_flip = NULL;
 	
 	// reset current map loot
@@ -78,9 +80,9 @@ void LootManager::loadGraphics() {
 			}
 			
 			if (new_anim) {
-				flying_loot[animation_count] = IMG_Load(("images/loot/" + anim_id + ".png").c_str());
+				loadAtlas(flying_loot[animation_count], "images/loot/" + anim_id + ".png");
 				
-				if (flying_loot[animation_count]) {
+				if (flying_loot[animation_count].getSheet()) {
 					animation_id[animation_count] = anim_id;
 					animation_count++;
 				}
@@ -89,27 +91,26 @@ void LootManager::loadGraphics() {
 	}
 	
 	// gold
-	flying_gold[0] = IMG_Load("images/loot/coins5.png");
-	flying_gold[1] = IMG_Load("images/loot/coins25.png");
-	flying_gold[2] = IMG_Load("images/loot/coins100.png");
-	
+	loadAtlas(flying_gold[0], "images/loot/coins5.png");
+	loadAtlas(flying_gold[1], "images/loot/coins25.png");
+	loadAtlas(flying_gold[2], "images/loot/coins100.png");
+}
+
+/**
+ * Load one flying loot animation and pack its frames
+ */
+void LootManager::loadAtlas(SpriteAtlas &atlas, string filename) {
+	SDL_Surface *sheet = IMG_Load(filename.c_str());
+	if (!sheet) return;
+
 	// set magic pink transparency
-	for (int i=0; i<animation_count; i++) {
-		SDL_SetColorKey( flying_loot[i], SDL_SRCCOLORKEY, SDL_MapRGB(flying_loot[i]->format, 255, 0, 255) ); 
-		
-		// optimize
-		SDL_Surface *cleanup = flying_loot[i];
-		flying_loot[i] = SDL_DisplayFormatAlpha(flying_loot[i]);
-		SDL_FreeSurface(cleanup);
-	}
-	for (int i=0; i<3; i++) {
-		SDL_SetColorKey( flying_gold[i], SDL_SRCCOLORKEY, SDL_MapRGB(flying_gold[i]->format, 255, 0, 255) ); 
+	SDL_SetColorKey( sheet, SDL_SRCCOLORKEY, SDL_MapRGB(sheet->format, 255, 0, 255) ); 
 		
-		// optimize
-		SDL_Surface *cleanup = flying_gold[i];
-		flying_gold[i] = SDL_DisplayFormatAlpha(flying_gold[i]);
-		SDL_FreeSurface(cleanup);
-	}
+	// optimize
+	sheet = optimizeSurface(sheet);
+
+	atlas.build(sheet, frame_size);
+	SDL_FreeSurface(sheet);
 }
 
 /**
@@ -155,6 +156,7 @@ void LootManager::calcTables() {
 
 void LootManager::handleNewMap() {
 	loot_count = 0;
+	grid.init(map->w, map->h);
 }
 
 void LootManager::logic() {
@@ -239,17 +241,18 @@ void LootManager::checkEnemiesForLoot() {
 	ItemStack istack;
 	istack.quantity = 1;
 	
-	for (int i=0; i<enemies->enemy_count; i++) {
+	for (unsigned k=0; k<enemies->awake.size(); k++) {
+		int i = enemies->awake[k];
 		if (enemies->enemies[i]->loot_drop) {
 			
 			if (enemies->enemies[i]->stats.quest_loot_id != 0) {				
 				// quest loot
 				istack.item = enemies->enemies[i]->stats.quest_loot_id;
-				addLoot(istack, enemies->enemies[i]->stats.pos);
+				addLoot(istack, enemies->getPos(i));
 			}
 			else {
 				// random loot
-				determineLoot(enemies->enemies[i]->stats.level, enemies->enemies[i]->stats.pos);
+				determineLoot(enemies->enemies[i]->stats.level, enemies->getPos(i));
 			}
 			
 			enemies->enemies[i]->loot_drop = false;
@@ -356,6 +359,7 @@ void LootManager::addLoot(ItemStack stack, Point pos) {
 	loot[loot_count].pos.y = pos.y;
 	loot[loot_count].frame = 0;
 	loot[loot_count].gold = 0;
+	grid.insert(loot_count, pos);
 	loot_count++;
 	if (loot_flip) Mix_PlayChannel(-1, loot_flip, 0);
 }
@@ -367,6 +371,7 @@ void LootManager::addGold(int count, Point pos) {
 	loot[loot_count].pos.y = pos.y;
 	loot[loot_count].frame = 0;
 	loot[loot_count].gold = count;
+	grid.insert(loot_count, pos);
 	loot_count++;
 	if (loot_flip) Mix_PlayChannel(-1, loot_flip, 0);	
 }
@@ -384,6 +389,12 @@ void LootManager::removeLoot(int index) {
 		loot[i].gold = loot[i+1].gold;
 	}
 	loot_count--;
+	
+	// later loot moved down one index; refile it all
+	grid.clear();
+	for (int i=0; i<loot_count; i++) {
+		grid.insert(i, loot[i].pos);
+	}
 }
 
 /**
@@ -399,10 +410,18 @@ ItemStack LootManager::checkPickup(Point mouse, Point cam, Point hero_pos, int &
 	loot_stack.item = 0;
 	loot_stack.quantity = 0;
 	
+	// only loot in grid cells around the hero can be in range
+	SDL_Rect area;
+	area.x = hero_pos.x - LOOT_RANGE;
+	area.y = hero_pos.y - LOOT_RANGE;
+	area.w = area.h = LOOT_RANGE * 2;
+	grid.query(area, found);
+	
 	// I'm starting at the end of the loot list so that more recently-dropped
 	// loot is picked up first.  If a player drops several loot in the same
 	// location, picking it back up will work like a stack.
-	for (int i=loot_count-1; i>=0; i--) {
+	for (int k=(int)found.size()-1; k>=0; k--) {
+		int i = found[k];
 
 		// loot close enough to pickup?
 		if (abs(hero_pos.x - loot[i].pos.x) < LOOT_RANGE && abs(hero_pos.y - loot[i].pos.y) < LOOT_RANGE && !isFlying(i)) {
@@ -447,40 +466,39 @@ Renderable LootManager::getRender(int index) {
 	// Right now the animation settings (number of frames, speed, frame size)
 	// are hard coded.  At least move these to consts in the header.
 
-	r.src.x = (loot[index].frame / anim_loot_duration) * 64;
+	r.src.x = (loot[index].frame / anim_loot_duration) * frame_size.x;
 	r.src.y = 0;
-	r.src.w = 64;
-	r.src.h = 128;
+	r.src.w = frame_size.x;
+	r.src.h = frame_size.y;
 	r.offset.x = 32;
 	r.offset.y = 112;
 	r.object_layer = true;
+	r.sprite = NULL;
 
+	SpriteAtlas *atlas = NULL;
 	if (loot[index].stack.item > 0) {
 		// item
 		for (int i=0; i<animation_count; i++) {
 			if (items->items[loot[index].stack.item].loot == animation_id[i])
-				r.sprite = flying_loot[i];
+				atlas = &flying_loot[i];
 		}
 	}
 	else if (loot[index].gold > 0) {
 		// gold
 		if (loot[index].gold <= 9)
-			r.sprite = flying_gold[0];
+			atlas = &flying_gold[0];
 		else if (loot[index].gold <= 25)
-			r.sprite = flying_gold[1];
+			atlas = &flying_gold[1];
 		else 
-			r.sprite = flying_gold[2];
+			atlas = &flying_gold[2];
 	}
+	
+	// look up the trimmed frame
+	if (atlas) atlas->apply(r);
 
 	return r;	
 }
 
 LootManager::~LootManager() {
-	for (int i=0; i<64; i++)
-		if (flying_loot[i])
-			SDL_FreeSurface(flying_loot[i]);
-	for (int i=0; i<3; i++)
-		if (flying_gold[i])
-			SDL_FreeSurface(flying_gold[i]);
 	if (loot_flip) Mix_FreeChunk(loot_flip);
 }
@@ -20,6 +20,8 @@
 #include "ItemDatabase.h"
 #include "MenuTooltip.h"
 #include "EnemyManager.h"
+#include "SpriteAtlas.h"
+#include "SpatialHash.h"
 
 struct LootDef {
 	ItemStack stack;
@@ -52,8 +54,10 @@ private:
 	void calcTables();
 	int lootLevel(int base_level);
 	
-	SDL_Surface *flying_loot[64];
-	SDL_Surface *flying_gold[3];
+	void loadAtlas(SpriteAtlas &atlas, string filename);
+	
+	SpriteAtlas flying_loot[64];
+	SpriteAtlas flying_gold[3];
 	
 	string animation_id[64];
 	int animation_count;
@@ -66,6 +70,10 @@ private:
 	// loot refers to ItemDatabase indices
 	LootDef loot[256]; // TODO: change to dynamic list without limits
 	
+	// loot indices by position
+	SpatialHash grid;
+	vector<int> found;
+	
 	// loot tables multiplied out
 	// currently loot can range from levels 0-20
 	int loot_table[21][1024]; // level, number.  the int is an item id
@@ -15,46 +15,137 @@
 using namespace std;
 
 MapCollision::MapCollision() {
+	cache_generation = 0;
+	clear();
 }
 
-void MapCollision::setmap(unsigned short _colmap[256][256]) {
-	for (int i=0; i<256; i++) {
-		for (int j=0; j<256; j++) {
-			colmap[i][j] = _colmap[i][j];
+/**
+ * Empty the collision layer
+ */
+void MapCollision::clear() {
+	for (int j=0; j<256; j++) {
+		for (int w=0; w<COLLISION_ROW_WORDS; w++) {
+			movement_bits[j][w] = 0;
+			sight_bits[j][w] = 0;
+			hidden_bits[j][w] = 0;
 		}
 	}
 	map_size.x = 0;
 	map_size.y = 0;
+	clearCache();
+}
+
+/**
+ * Store one tile of the collision layer.
+ * Unknown non-zero types are kept as BLOCKS_MOVEMENT.
+ * Call clearCache() when done changing tiles.
+ */
+void MapCollision::setTile(int tile_x, int tile_y, int type) {
+	if (tile_x < 0 || tile_y < 0 || tile_x >= 256 || tile_y >= 256) return;
+
+	int w = tile_x >> 5;
+	Uint32 bit = 1u << (tile_x & 31);
+	
+	movement_bits[tile_y][w] &= ~bit;
+	sight_bits[tile_y][w] &= ~bit;
+	hidden_bits[tile_y][w] &= ~bit;
+	
+	if (type != 0) movement_bits[tile_y][w] |= bit;
+	if (type == BLOCKS_ALL || type == BLOCKS_ALL_HIDDEN) sight_bits[tile_y][w] |= bit;
+	if (type == BLOCKS_ALL_HIDDEN || type == BLOCKS_MOVEMENT_HIDDEN) hidden_bits[tile_y][w] |= bit;
+}
+
+/**
+ * Rebuild the collision type of one tile from the bit planes
+ */
+int MapCollision::getTile(int tile_x, int tile_y) {
+	if (tile_x < 0 || tile_y < 0 || tile_x >= 256 || tile_y >= 256) return 0;
+
+	int w = tile_x >> 5;
+	int b = tile_x & 31;
+	if (((movement_bits[tile_y][w] >> b) & 1) == 0) return 0;
+	
+	bool sight = (sight_bits[tile_y][w] >> b) & 1;
+	bool hidden = (hidden_bits[tile_y][w] >> b) & 1;
+	if (sight) return hidden ? BLOCKS_ALL_HIDDEN : BLOCKS_ALL;
+	return hidden ? BLOCKS_MOVEMENT_HIDDEN : BLOCKS_MOVEMENT;
 }
 
 /**
  * Process movement for cardinal (90 degree) and ordinal (45 degree) directions
  * If we encounter an obstacle at 90 degrees, stop.
  * If we encounter an obstacle at 45 or 135 degrees, slide.
+ *
+ * The result is the same as testing one map unit at a time, but whole runs
+ * of units are taken at once: the outcome of a test only depends on which
+ * tiles x, x+step_x, y and y+step_y fall in, so it can't change until one of
+ * those crosses a tile edge.
  */
 bool MapCollision::move(int &x, int &y, int step_x, int step_y, int dist) {
 
 	bool diag = false;
 	if (step_x != 0 && step_y != 0) diag = true;
 	
-	for (int i=0; i<dist; i++) {
+	// runs only work for unit steps
+	if (step_x < -1 || step_x > 1 || step_y < -1 || step_y > 1) {
+		for (int i=0; i<dist; i++) {
+			if (is_empty(x + step_x, y + step_y)) {
+				x+= step_x;
+				y+= step_y;
+			}
+			else if (diag && is_empty(x + step_x, y)) { // slide along wall
+				x+= step_x;
+			}
+			else if (diag && is_empty(x, y + step_y)) { // slide along wall
+				y+= step_y;
+			}
+			else { // absolute stop
+				return false;
+			}
+		}
+		return true;
+	}
+
+	int run;
+	while (dist > 0) {
 		if (is_empty(x + step_x, y + step_y)) {
-			x+= step_x;
-			y+= step_y;
+			run = min(dist, min(tile_run(x, step_x), tile_run(y, step_y)));
+			x+= step_x * run;
+			y+= step_y * run;
 		}
 		else if (diag && is_empty(x + step_x, y)) { // slide along wall
-			x+= step_x;
+			run = min(dist, tile_run(x, step_x));
+			x+= step_x * run;
 		}
 		else if (diag && is_empty(x, y + step_y)) { // slide along wall
-			y+= step_y;
+			run = min(dist, tile_run(y, step_y));
+			y+= step_y * run;
 		}
 		else { // absolute stop
 			return false;
 		}
+		dist -= run;
 	}
 	return true;
 }
 
+/**
+ * How many unit steps from v keep both v and v+step in the same tiles
+ * as they are now.  Always at least 1.
+ */
+int MapCollision::tile_run(int v, int step) {
+	int r = v & (UNITS_PER_TILE - 1);
+	if (step > 0) {
+		if (r == UNITS_PER_TILE - 1) return 1;
+		return UNITS_PER_TILE - 1 - r;
+	}
+	if (step < 0) {
+		if (r == 0) return 1;
+		return r;
+	}
+	return INT_MAX;
+}
+
 bool MapCollision::outsideMap(int tile_x, int tile_y) {
 	if (tile_x < 0 || tile_y < 0 || tile_x >= map_size.x || tile_y >= map_size.y) return true;
 	return false;
@@ -67,9 +158,7 @@ bool MapCollision::is_empty(int x, int y) {
 	// bounds check
 	if (outsideMap(tile_x, tile_y)) return false;
 
-	if (colmap[tile_x][tile_y] == 0)
-		return true;
-	return false;
+	return ((movement_bits[tile_y][tile_x >> 5] >> (tile_x & 31)) & 1) == 0;
 }
 
 bool MapCollision::is_wall(int x, int y) {
@@ -79,16 +168,157 @@ bool MapCollision::is_wall(int x, int y) {
 	// bounds check
 	if (outsideMap(tile_x, tile_y)) return true;
 	
-	if (colmap[tile_x][tile_y] == BLOCKS_ALL || colmap[tile_x][tile_y] == BLOCKS_ALL_HIDDEN)
-		return true;
-	return false;
+	return ((sight_bits[tile_y][tile_x >> 5] >> (tile_x & 31)) & 1) != 0;
+}
+
+/**
+ * is_wall() for one tile, as a sweep_walls result
+ */
+char MapCollision::probe_tile(int tile_x, int tile_y) {
+	if (outsideMap(tile_x, tile_y)) return PROBE_OUTSIDE;
+	if ((sight_bits[tile_y][tile_x >> 5] >> (tile_x & 31)) & 1) return PROBE_WALL;
+	return PROBE_OPEN;
+}
+
+/**
+ * is_wall() along many short moves at once, e.g. every moving hazard.
+ *
+ * Each move from[i] to to[i] walks the tiles it crosses in order and stops
+ * at the first wall, so fast movers can't skip thin walls or cut corners.
+ * A move through the exact corner of a tile is blocked when either tile
+ * beside the corner is, as in move().  A move that stays inside one tile
+ * only tests that tile.
+ *
+ * @param result PROBE_OPEN, PROBE_WALL or PROBE_OUTSIDE for each move
+ * @param hit where each blocked move enters the wall (to[i] if it ends in its start tile)
+ */
+void MapCollision::sweep_walls(const vector<Point> &from, const vector<Point> &to, vector<char> &result, vector<Point> &hit) {
+	result.resize(to.size());
+	hit.resize(to.size());
+	
+	for (unsigned i=0; i<to.size(); i++) {
+		int x1 = from[i].x;
+		int y1 = from[i].y;
+		int x2 = to[i].x;
+		int y2 = to[i].y;
+		int tile_x = x1 >> TILE_SHIFT;
+		int tile_y = y1 >> TILE_SHIFT;
+		int end_x = x2 >> TILE_SHIFT;
+		int end_y = y2 >> TILE_SHIFT;
+		
+		result[i] = PROBE_OPEN;
+		hit[i] = to[i];
+		
+		// most moves stay inside one tile
+		if (tile_x == end_x && tile_y == end_y) {
+			result[i] = probe_tile(end_x, end_y);
+			continue;
+		}
+		
+		// step to whichever tile border the line reaches first
+		int dx = x2 - x1;
+		int dy = y2 - y1;
+		int step_x = (dx > 0) - (dx < 0);
+		int step_y = (dy > 0) - (dy < 0);
+		float next_x = 2.0f; // past the end of the move
+		float next_y = 2.0f;
+		float delta_x = 0;
+		float delta_y = 0;
+		if (dx != 0) {
+			next_x = (float)(((tile_x + (dx > 0)) << TILE_SHIFT) - x1) / dx;
+			delta_x = (float)UNITS_PER_TILE / abs(dx);
+		}
+		if (dy != 0) {
+			next_y = (float)(((tile_y + (dy > 0)) << TILE_SHIFT) - y1) / dy;
+			delta_y = (float)UNITS_PER_TILE / abs(dy);
+		}
+		
+		// each step moves at least one axis toward the end tile,
+		// both at once where the line goes exactly through a tile corner
+		while (tile_x != end_x || tile_y != end_y) {
+			bool move_x = tile_x != end_x && (tile_y == end_y || next_x <= next_y);
+			bool move_y = tile_y != end_y && (tile_x == end_x || next_y <= next_x);
+			float t = move_x ? next_x : next_y;
+			char probe = PROBE_OPEN;
+			
+			// squeezing between two walls that only touch at this corner
+			if (move_x && move_y) {
+				probe = probe_tile(tile_x + step_x, tile_y);
+				if (probe == PROBE_OPEN) probe = probe_tile(tile_x, tile_y + step_y);
+			}
+			
+			if (move_x) {
+				tile_x += step_x;
+				next_x += delta_x;
+			}
+			if (move_y) {
+				tile_y += step_y;
+				next_y += delta_y;
+			}
+			
+			if (probe == PROBE_OPEN) probe = probe_tile(tile_x, tile_y);
+			if (probe != PROBE_OPEN) {
+				result[i] = probe;
+				hit[i].x = x1 + (int)(dx * t);
+				hit[i].y = y1 + (int)(dy * t);
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Does this tile stop a line of the given check type?
+ */
+bool MapCollision::tile_blocks(int tile_x, int tile_y, int checktype) {
+	if (outsideMap(tile_x, tile_y)) return true;
+	
+	if (checktype == CHECK_SIGHT)
+		return ((sight_bits[tile_y][tile_x >> 5] >> (tile_x & 31)) & 1) != 0;
+	return ((movement_bits[tile_y][tile_x >> 5] >> (tile_x & 31)) & 1) != 0;
+}
+
+/**
+ * Is every tile from tile_x1 to tile_x2 (inclusive) on this row open?
+ * Tests 32 tiles per word.
+ */
+bool MapCollision::row_clear(int tile_y, int tile_x1, int tile_x2, int checktype) {
+	if (tile_x1 > tile_x2) swap(tile_x1, tile_x2);
+	if (outsideMap(tile_x1, tile_y) || outsideMap(tile_x2, tile_y)) return false;
+
+	Uint32 *row = (checktype == CHECK_SIGHT) ? sight_bits[tile_y] : movement_bits[tile_y];
+	int w1 = tile_x1 >> 5;
+	int w2 = tile_x2 >> 5;
+	Uint32 first = ~0u << (tile_x1 & 31);
+	Uint32 last = ~0u >> (31 - (tile_x2 & 31));
+	
+	if (w1 == w2) return (row[w1] & first & last) == 0;
+	if (row[w1] & first) return false;
+	for (int w=w1+1; w<w2; w++) {
+		if (row[w]) return false;
+	}
+	return (row[w2] & last) == 0;
 }
 
 /**
  * Does not have the "slide" submovement that move() features
  * Line can be arbitrary angles.
+ *
+ * The line is sampled once per map unit along its major axis.  Both
+ * coordinates are accumulated in float one sample at a time and rounded, as
+ * they always have been, so every sample and the reported end point stay
+ * the same.  Only the collision test is skipped while the samples stay in
+ * the tile that was tested last.
  */
-bool MapCollision::line_check(int x1, int y1, int x2, int y2, int checktype) {
+bool MapCollision::line_check(int x1, int y1, int x2, int y2, int checktype, int &end_x, int &end_y) {
+	
+	// a horizontal line is clear if the whole span of its row is
+	if (y1 == y2 && row_clear(y1 >> TILE_SHIFT, x1 >> TILE_SHIFT, x2 >> TILE_SHIFT, checktype)) {
+		end_x = x2;
+		end_y = y2;
+		return true;
+	}
+	
 	float x = (float)x1;
 	float y = (float)y1;
 	float dx = (float)abs(x2 - x1);
@@ -97,7 +327,6 @@ bool MapCollision::line_check(int x1, int y1, int x2, int y2, int checktype) {
 	float step_y;
 	int steps = (int)max(dx, dy);
 
-
 	if (dx > dy) {
 		step_x = 1;
 		step_y = dy / dx;
@@ -110,45 +339,94 @@ bool MapCollision::line_check(int x1, int y1, int x2, int y2, int checktype) {
 	if (x1 > x2) step_x = -step_x;
 	if (y1 > y2) step_y = -step_y;
 
-	
-	if (checktype == CHECK_SIGHT) {
-		for (int i=0; i<steps; i++) {
-			x += step_x;
-			y += step_y;
-			if (is_wall(round(x), round(y))) {
-				result_x = round(x -= step_x);
-				result_y = round(y -= step_y);
-				return false;
-			}
-		}
-	}
-	else if (checktype == CHECK_MOVEMENT) {
-		for (int i=0; i<steps; i++) {
-			x += step_x;
-			y += step_y;
-			if (!is_empty(round(x), round(y))) {
-				result_x = round(x -= step_x);
-				result_y = round(y -= step_y);
-				return false;
-			}
+	int last_tile_x = 0;
+	int last_tile_y = 0;
+	for (int i=0; i<steps; i++) {
+		x += step_x;
+		y += step_y;
+		int tile_x = round(x) >> TILE_SHIFT;
+		int tile_y = round(y) >> TILE_SHIFT;
+		if (i > 0 && tile_x == last_tile_x && tile_y == last_tile_y) continue;
+		last_tile_x = tile_x;
+		last_tile_y = tile_y;
+
+		if (tile_blocks(tile_x, tile_y, checktype)) {
+			// report the last sample before the obstacle
+			end_x = round(x - step_x);
+			end_y = round(y - step_y);
+			return false;
 		}
 	}
 	
-	result_x = x2;
-	result_y = y2;
+	end_x = x2;
+	end_y = y2;
 	return true;
 }
 
-bool MapCollision::line_of_sight(int x1, int y1, int x2, int y2) {
-	return line_check(x1, y1, x2, y2, CHECK_SIGHT);
+/**
+ * Line checks only depend on the endpoints and the collision layer,
+ * so repeated queries between the same two points are answered from the cache.
+ * Slots are picked by source and target tile; entries must match exactly.
+ */
+int MapCollision::cache_slot(int x1, int y1, int x2, int y2, int checktype) {
+	int hash = (x1 >> TILE_SHIFT) * 7 + (y1 >> TILE_SHIFT) * 131 + (x2 >> TILE_SHIFT) * 1031 + (y2 >> TILE_SHIFT) * 8191 + checktype;
+	return (hash & 0x7fffffff) % LINE_CACHE_SIZE;
+}
+
+bool MapCollision::cached_line_check(int x1, int y1, int x2, int y2, int checktype) {
+	Line_Cache_Entry &e = line_cache[cache_slot(x1, y1, x2, y2, checktype)];
+	
+	if (e.generation == cache_generation && e.checktype == checktype &&
+	    e.x1 == x1 && e.y1 == y1 && e.x2 == x2 && e.y2 == y2) {
+		result_x = e.result_x;
+		result_y = e.result_y;
+		return e.clear;
+	}
+	
+	e.clear = line_check(x1, y1, x2, y2, checktype, result_x, result_y);
+	e.x1 = x1;
+	e.y1 = y1;
+	e.x2 = x2;
+	e.y2 = y2;
+	e.checktype = checktype;
+	e.generation = cache_generation;
+	e.result_x = result_x;
+	e.result_y = result_y;
+	return e.clear;
 }
-bool MapCollision::line_of_movement(int x1, int y1, int x2, int y2) {
-	return line_check(x1, y1, x2, y2, CHECK_MOVEMENT);
 
+/**
+ * Line check for code running in parallel, e.g. the enemy AI workers.
+ * Nothing is written, so any number of threads may call this together.
+ */
+bool MapCollision::line_clear(int x1, int y1, int x2, int y2, int checktype) {
+	Line_Cache_Entry &e = line_cache[cache_slot(x1, y1, x2, y2, checktype)];
+	
+	if (e.generation == cache_generation && e.checktype == checktype &&
+	    e.x1 == x1 && e.y1 == y1 && e.x2 == x2 && e.y2 == y2) {
+		return e.clear;
+	}
+	
+	int end_x, end_y;
+	return line_check(x1, y1, x2, y2, checktype, end_x, end_y);
 }
 
+void MapCollision::clearCache() {
+	cache_generation++;
+	if (cache_generation == 1) {
+		for (int i=0; i<LINE_CACHE_SIZE; i++) {
+			line_cache[i].generation = 0;
+		}
+	}
+}
+
+bool MapCollision::line_of_sight(int x1, int y1, int x2, int y2) {
+	return cached_line_check(x1, y1, x2, y2, CHECK_SIGHT);
+}
+bool MapCollision::line_of_movement(int x1, int y1, int x2, int y2) {
+	return cached_line_check(x1, y1, x2, y2, CHECK_MOVEMENT);
 
-// TODO: A*
+}
 
 MapCollision::~MapCollision() {
 }
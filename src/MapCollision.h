@@ -13,7 +13,9 @@
 #define MAP_COLLISION_H
 
 #include <algorithm>
+#include <vector>
 #include <stdlib.h>
+#include <limits.h>
 #include "Utils.h"
 #include "Settings.h"
 
@@ -27,24 +29,67 @@ const int BLOCKS_MOVEMENT_HIDDEN = 4;
 const int CHECK_MOVEMENT = 1;
 const int CHECK_SIGHT = 2;
 
+// sweep_walls results
+const char PROBE_OPEN = 0;
+const char PROBE_WALL = 1;
+const char PROBE_OUTSIDE = 2; // off the map, which also counts as a wall
+
+// the collision layer is packed one bit per tile, in rows of 32-bit words
+const int COLLISION_ROW_WORDS = 256 / 32;
+
+// line check results are remembered in a small direct-mapped cache
+const int LINE_CACHE_SIZE = 256;
+
+struct Line_Cache_Entry {
+	int x1, y1, x2, y2;
+	int checktype;
+	int generation;
+	bool clear;
+	int result_x;
+	int result_y;
+};
+
 class MapCollision {
 private:
 
-	bool line_check(int x1, int y1, int x2, int y2, int checktype);
+	bool line_check(int x1, int y1, int x2, int y2, int checktype, int &end_x, int &end_y);
+	bool cached_line_check(int x1, int y1, int x2, int y2, int checktype);
+	int cache_slot(int x1, int y1, int x2, int y2, int checktype);
+	int tile_run(int v, int step);
+	bool row_clear(int tile_y, int tile_x1, int tile_x2, int checktype);
+	char probe_tile(int tile_x, int tile_y);
+	
+	// bit planes, indexed [tile_y][tile_x / 32]
+	Uint32 movement_bits[256][COLLISION_ROW_WORDS]; // blocks movement: every non-empty type
+	Uint32 sight_bits[256][COLLISION_ROW_WORDS];    // blocks sight: BLOCKS_ALL, BLOCKS_ALL_HIDDEN
+	Uint32 hidden_bits[256][COLLISION_ROW_WORDS];   // BLOCKS_ALL_HIDDEN, BLOCKS_MOVEMENT_HIDDEN
+	
+	Line_Cache_Entry line_cache[LINE_CACHE_SIZE];
+	int cache_generation;
 	
 public:
 	MapCollision();
 	~MapCollision();
-	void setmap(unsigned short _colmap[256][256]);
+	void clear();
+	void setTile(int tile_x, int tile_y, int type);
+	int getTile(int tile_x, int tile_y);
 	bool move(int &x, int &y, int step_x, int step_y, int dist);
 	bool outsideMap(int tile_x, int tile_y);
 	bool is_empty(int x, int y);
 	bool is_wall(int x, int y);
+	void sweep_walls(const vector<Point> &from, const vector<Point> &to, vector<char> &result, vector<Point> &hit);
+	bool tile_blocks(int tile_x, int tile_y, int checktype);
 
 	bool line_of_sight(int x1, int y1, int x2, int y2);
 	bool line_of_movement(int x1, int y1, int x2, int y2);
+	
+	// safe from several threads at once while the map doesn't change:
+	// reads the cache without filling it and leaves result_x/y alone
+	bool line_clear(int x1, int y1, int x2, int y2, int checktype);
+	
+	// call whenever the collision layer changes
+	void clearCache();
 
-	unsigned short colmap[256][256];
 	Point map_size;
 		
 	int result_x;
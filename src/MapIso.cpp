@@ -33,6 +33,9 @@ MapIso::MapIso(SDL_Surface *_screen, CampaignManager *_camp) {
 	log_msg = "";
 	shaky_cam_ticks = 0;
 	
+	background_buffer = NULL;
+	background_valid = false;
+	
 	// spawn is a special map that defines where the campaign begins
 	// load("spawn.txt");
 }
@@ -40,31 +43,11 @@ MapIso::MapIso(SDL_Surface *_screen, CampaignManager *_camp) {
 
 
 void MapIso::clearEvents() {
-	for (int i=0; i<256; i++) {
-		events[i].type = "";
-		events[i].location.x = 0;
-		events[i].location.y = 0;
-		events[i].location.w = 0;
-		events[i].location.h = 0;
-		events[i].comp_num = 0;
-		for (int j=0; j<8; j++) {
-			events[i].components[j].type = "";
-			events[i].components[j].s = "";
-			events[i].components[j].x = 0;
-			events[i].components[j].y = 0;
-			events[i].components[j].z = 0;
-		}
-	}
-	event_count = 0;
-}
-
-void MapIso::removeEvent(int eid) {
-	for (int i=eid; i<event_count; i++) {
-		if (i<256) {
-			events[i] = events[i+1];
-		}
-	}
-	event_count--;
+	events.clear();
+	event_cells.clear();
+	event_ids.clear();
+	event_tile.x = event_tile.y = -1;
+	event_scripts.clear();
 }
 
 void MapIso::clearEnemy(Map_Enemy e) {
@@ -101,8 +84,7 @@ int MapIso::load(string filename) {
 	string data_format;
   
 	clearEvents();
-  
-    event_count = 0;
+	collider.clear();
   
 	if (infile.open(("maps/" + filename).c_str())) {
 		while (infile.next()) {
@@ -128,7 +110,13 @@ int MapIso::load(string filename) {
 					npc_awaiting_queue = true;
 				}
 				else if (infile.section == "event") {
-					event_count++;
+					Map_Event e;
+					e.type = ATOM_NONE;
+					e.location.x = e.location.y = 0;
+					e.location.w = e.location.h = 0;
+					e.script = event_scripts.beginProgram();
+					e.removed = false;
+					events.push_back(e);
 				}
 				
 			}
@@ -178,7 +166,7 @@ int MapIso::load(string filename) {
 							for (int i=0; i<w; i++) {
 								if (cur_layer == "background") background[i][j] = eatFirstHex(val, ',');
 								else if (cur_layer == "object") object[i][j] = eatFirstHex(val, ',');
-								else if (cur_layer == "collision") collision[i][j] = eatFirstHex(val, ',');
+								else if (cur_layer == "collision") collider.setTile(i, j, eatFirstHex(val, ','));
 							}
 						}
 					}
@@ -188,7 +176,7 @@ int MapIso::load(string filename) {
 							for (int i=0; i<w; i++) {
 								if (cur_layer == "background") background[i][j] = eatFirstInt(val, ',');
 								else if (cur_layer == "object") object[i][j] = eatFirstInt(val, ',');
-								else if (cur_layer == "collision") collision[i][j] = eatFirstInt(val, ',');
+								else if (cur_layer == "collision") collider.setTile(i, j, eatFirstInt(val, ','));
 							}
 						}
 					}
@@ -219,19 +207,20 @@ int MapIso::load(string filename) {
 			}
 			else if (infile.section == "event") {
 				if (infile.key == "type") {
-					events[event_count-1].type = infile.val;
+					events.back().type = atom(infile.val);
 				}
 				else if (infile.key == "location") {
 					val = infile.val + ",";
-					events[event_count-1].location.x = eatFirstInt(val, ',');
-					events[event_count-1].location.y = eatFirstInt(val, ',');
-					events[event_count-1].location.w = eatFirstInt(val, ',');
-					events[event_count-1].location.h = eatFirstInt(val, ',');
+					events.back().location.x = eatFirstInt(val, ',');
+					events.back().location.y = eatFirstInt(val, ',');
+					events.back().location.w = eatFirstInt(val, ',');
+					events.back().location.h = eatFirstInt(val, ',');
 				}
 				else {
 					// new event component
-					Event_Component *e = &events[event_count-1].components[events[event_count-1].comp_num];
-					e->type = infile.key;
+					Event_Component component;
+					Event_Component *e = &component;
+					e->type = atom(infile.key);
 					
 					if (infile.key == "intermap") {
 						val = infile.val + ",";
@@ -285,7 +274,7 @@ int MapIso::load(string filename) {
 						e->x = atoi(infile.val.c_str());
 					}
 					
-					events[event_count-1].comp_num++;
+					event_scripts.add(component);
 				}
 			}
 		}
@@ -303,15 +292,23 @@ int MapIso::load(string filename) {
 		}
 	}
 
-	collider.setmap(collision);
 	collider.map_size.x = w;
 	collider.map_size.y = h;
+	pathfinder.init(&collider);
+	flowfield.init(&collider);
+	fov.init(&collider);
+	planner.init(&collider);
+	indexEvents();
 	
 	if (this->new_music) {
 		loadMusic();
 		this->new_music = false;
 	}
 	tset.load(this->tileset);
+	
+	// the background buffer holds the previous map
+	background_valid = false;
+	background_changed.clear();
 
 	return 0;
 }
@@ -336,6 +333,7 @@ void MapIso::loadMusic() {
 
 void MapIso::logic() {
 	if (shaky_cam_ticks > 0) shaky_cam_ticks--;
+	pathfinder.beginFrame();
 }
 
 void MapIso::render(Renderable r[], int rnum) {
@@ -372,28 +370,12 @@ void MapIso::render(Renderable r[], int rnum) {
 		ycam.y = (cam.y + rand() % 16 - 8) /UNITS_PER_PIXEL_Y;
 	}
 	
-	// todo: trim by screen rect
 	// background
-	for (j=0; j<h; j++) {
-		for (i=0; i<w; i++) {
-		  
-			current_tile = background[i][j];
-			
-			if (current_tile > 0) {			
-			
-				dest.x = VIEW_W_HALF + (i * TILE_W_HALF - xcam.x) - (j * TILE_W_HALF - xcam.y);
-				dest.y = VIEW_H_HALF + (i * TILE_H_HALF - ycam.x) + (j * TILE_H_HALF - ycam.y) + TILE_H_HALF;
-				// adding TILE_H_HALF gets us to the tile center instead of top corner
-				dest.x -= tset.tiles[current_tile].offset.x;
-				dest.y -= tset.tiles[current_tile].offset.y;
-				dest.w = tset.tiles[current_tile].src.w;
-				dest.h = tset.tiles[current_tile].src.h;
-				
-				SDL_BlitSurface(tset.sprites, &(tset.tiles[current_tile].src), screen, &dest);
-	
-			}
-		}
-	}
+	// screen position of the center of tile (0,0); every other tile is a fixed step from here
+	Point origin;
+	origin.x = VIEW_W_HALF - xcam.x + xcam.y;
+	origin.y = VIEW_H_HALF - ycam.x - ycam.y + TILE_H_HALF;
+	renderBackground(origin);
 
 	// some renderables are drawn above the background and below the objects
 	for (int ri = 0; ri < rnum; ri++) {			
@@ -451,86 +433,320 @@ void MapIso::render(Renderable r[], int rnum) {
 	}
 }
 
+/**
+ * Draw the background layer through the scroll-reuse buffer.
+ * When the camera moves, the pixels still on screen are shifted and only
+ * the newly exposed strips and tiles changed by mapmod are redrawn.
+ */
+void MapIso::renderBackground(Point origin) {
+
+	if (background_buffer == NULL) {
+		SDL_PixelFormat *fmt = screen->format;
+		background_buffer = SDL_CreateRGBSurface(SDL_SWSURFACE, VIEW_W, VIEW_H, fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, 0);
+		if (background_buffer == NULL) {
+			fprintf(stderr, "Couldn't create background buffer: %s\n", SDL_GetError());
+			SDL_Quit();
+			return;
+		}
+		background_valid = false;
+	}
+
+	SDL_Rect area;
+	int dx = origin.x - background_origin.x;
+	int dy = origin.y - background_origin.y;
+
+	if (!background_valid || abs(dx) >= VIEW_W || abs(dy) >= VIEW_H) {
+		calcTileBounds();
+		area.x = area.y = 0;
+		area.w = VIEW_W;
+		area.h = VIEW_H;
+		drawBackground(area, origin);
+		background_valid = true;
+		background_changed.clear();
+	}
+	else if (dx != 0 || dy != 0) {
+		scrollBackground(dx, dy);
+		
+		// exposed columns
+		if (dx != 0) {
+			area.x = (dx > 0) ? 0 : VIEW_W + dx;
+			area.y = 0;
+			area.w = abs(dx);
+			area.h = VIEW_H;
+			drawBackground(area, origin);
+		}
+		
+		// exposed rows
+		if (dy != 0) {
+			area.x = 0;
+			area.y = (dy > 0) ? 0 : VIEW_H + dy;
+			area.w = VIEW_W;
+			area.h = abs(dy);
+			drawBackground(area, origin);
+		}
+	}
+	background_origin = origin;
+	
+	// tiles changed by map events
+	for (unsigned k=0; k<background_changed.size(); k++) {
+		Point tile = background_changed[k];
+		area.x = origin.x + (tile.x - tile.y) * TILE_W_HALF + tile_bounds.x;
+		area.y = origin.y + (tile.x + tile.y) * TILE_H_HALF + tile_bounds.y;
+		area.w = tile_bounds.w;
+		area.h = tile_bounds.h;
+		drawBackground(area, origin);
+	}
+	background_changed.clear();
+
+	SDL_BlitSurface(background_buffer, NULL, screen, NULL);
+}
+
+/**
+ * Move the buffer contents by (dx,dy) pixels in place
+ */
+void MapIso::scrollBackground(int dx, int dy) {
+	SDL_Surface *buf = background_buffer;
+	int bpp = buf->format->BytesPerPixel;
+	int row_len = (VIEW_W - abs(dx)) * bpp;
+	int dest_x = (dx > 0) ? dx * bpp : 0;
+	int src_x = (dx < 0) ? -dx * bpp : 0;
+	Uint8 *pixels;
+
+	if (SDL_MUSTLOCK(buf)) SDL_LockSurface(buf);
+	pixels = (Uint8*)buf->pixels;
+
+	// walk rows against the direction of movement so no source row is overwritten before it is copied
+	if (dy > 0) {
+		for (int y = VIEW_H-1; y >= dy; y--) {
+			memmove(pixels + y * buf->pitch + dest_x, pixels + (y - dy) * buf->pitch + src_x, row_len);
+		}
+	}
+	else {
+		for (int y = 0; y < VIEW_H + dy; y++) {
+			memmove(pixels + y * buf->pitch + dest_x, pixels + (y - dy) * buf->pitch + src_x, row_len);
+		}
+	}
+
+	if (SDL_MUSTLOCK(buf)) SDL_UnlockSurface(buf);
+}
+
+/**
+ * Redraw the background tiles overlapping one area of the buffer
+ * Tiles are drawn in the usual map order so overlaps come out the same
+ */
+void MapIso::drawBackground(SDL_Rect area, Point origin) {
+	SDL_Rect dest;
+	SDL_Rect clip;
+	int current_tile;
+
+	// clip to the buffer in ints; SDL_Rect's w and h are unsigned
+	int x0 = max((int)area.x, 0);
+	int y0 = max((int)area.y, 0);
+	int x1 = min((int)area.x + (int)area.w, VIEW_W);
+	int y1 = min((int)area.y + (int)area.h, VIEW_H);
+	if (x1 <= x0 || y1 <= y0) return;
+
+	area.x = x0;
+	area.y = y0;
+	area.w = x1 - x0;
+	area.h = y1 - y0;
+	clip = area;
+	SDL_SetClipRect(background_buffer, &clip);
+	SDL_FillRect(background_buffer, &clip, 0);
+
+	// range of tile centers whose graphics may touch the area
+	int ax0 = area.x - (tile_bounds.x + tile_bounds.w) - origin.x;
+	int ax1 = area.x + area.w - tile_bounds.x - origin.x;
+	int ay0 = area.y - (tile_bounds.y + tile_bounds.h) - origin.y;
+	int ay1 = area.y + area.h - tile_bounds.y - origin.y;
+	
+	// convert to (i-j) and (i+j), then to a box of i,j
+	int u0 = ax0 / TILE_W_HALF - 1;
+	int u1 = ax1 / TILE_W_HALF + 1;
+	int v0 = ay0 / TILE_H_HALF - 1;
+	int v1 = ay1 / TILE_H_HALF + 1;
+	int i0 = max((u0 + v0) / 2 - 1, 0);
+	int i1 = min((u1 + v1) / 2 + 1, w - 1);
+	int j0 = max((v0 - u1) / 2 - 1, 0);
+	int j1 = min((v1 - u0) / 2 + 1, h - 1);
+
+	for (int j=j0; j<=j1; j++) {
+		for (int i=i0; i<=i1; i++) {
+		  
+			current_tile = background[i][j];
+			
+			if (current_tile > 0) {			
+			
+				dest.x = origin.x + (i - j) * TILE_W_HALF - tset.tiles[current_tile].offset.x;
+				dest.y = origin.y + (i + j) * TILE_H_HALF - tset.tiles[current_tile].offset.y;
+				
+				// skip tiles outside the area
+				if (dest.x >= area.x + area.w || dest.y >= area.y + area.h) continue;
+				if (dest.x + tset.tiles[current_tile].src.w <= area.x) continue;
+				if (dest.y + tset.tiles[current_tile].src.h <= area.y) continue;
+				
+				dest.w = tset.tiles[current_tile].src.w;
+				dest.h = tset.tiles[current_tile].src.h;
+				
+				SDL_BlitSurface(tset.sprites, &(tset.tiles[current_tile].src), background_buffer, &dest);
+			}
+		}
+	}
+
+	SDL_SetClipRect(background_buffer, NULL);
+}
+
+/**
+ * Find how far tile graphics can reach from a tile center
+ */
+void MapIso::calcTileBounds() {
+	int left = 0;
+	int top = 0;
+	int right = 0;
+	int bottom = 0;
+
+	for (int i=0; i<256; i++) {
+		if (tset.tiles[i].src.w == 0) continue;
+		left = min(left, -tset.tiles[i].offset.x);
+		top = min(top, -tset.tiles[i].offset.y);
+		right = max(right, tset.tiles[i].src.w - tset.tiles[i].offset.x);
+		bottom = max(bottom, tset.tiles[i].src.h - tset.tiles[i].offset.y);
+	}
+	tile_bounds.x = left;
+	tile_bounds.y = top;
+	tile_bounds.w = right - left;
+	tile_bounds.h = bottom - top;
+}
+
+/**
+ * File each event under every tile of its location, clipped to the map
+ */
+void MapIso::indexEvents() {
+	int map_w = min(max(w, 0), 256);
+	int map_h = min(max(h, 0), 256);
+	int x1, y1, x2, y2;
+	
+	// count the events on each tile, then turn the counts into offsets
+	event_cells.assign(map_w * map_h + 1, 0);
+	for (unsigned i=0; i<events.size(); i++) {
+		const SDL_Rect &r = events[i].location;
+		x1 = max((int)r.x, 0);
+		y1 = max((int)r.y, 0);
+		x2 = min(r.x + r.w, map_w);
+		y2 = min(r.y + r.h, map_h);
+		for (int y=y1; y<y2; y++)
+			for (int x=x1; x<x2; x++)
+				event_cells[y*map_w + x + 1]++;
+	}
+	for (int i=0; i<map_w * map_h; i++) {
+		event_cells[i+1] += event_cells[i];
+	}
+	
+	// fill in event ids, in event order within each tile
+	event_ids.resize(event_cells[map_w * map_h]);
+	vector<int> cursor(event_cells.begin(), event_cells.end() - 1);
+	for (unsigned i=0; i<events.size(); i++) {
+		const SDL_Rect &r = events[i].location;
+		x1 = max((int)r.x, 0);
+		y1 = max((int)r.y, 0);
+		x2 = min(r.x + r.w, map_w);
+		y2 = min(r.y + r.h, map_h);
+		for (int y=y1; y<y2; y++)
+			for (int x=x1; x<x2; x++)
+				event_ids[cursor[y*map_w + x]++] = i;
+	}
+}
+
+/**
+ * Events trigger when the hero steps onto one of their tiles
+ */
 void MapIso::checkEvents(Point loc) {
 	Point maploc;
 	maploc.x = loc.x >> TILE_SHIFT;
 	maploc.y = loc.y >> TILE_SHIFT;
-	for (int i=0; i<event_count; i++) {
-		if (maploc.x >= events[i].location.x &&
-		    maploc.y >= events[i].location.y &&
-		    maploc.x <= events[i].location.x + events[i].location.w-1 &&
-			maploc.y <= events[i].location.y + events[i].location.h-1) {
-			executeEvent(i);
-		}
+	
+	if (event_cells.empty()) return; // no map loaded yet
+	if (maploc.x == event_tile.x && maploc.y == event_tile.y) return;
+	event_tile = maploc;
+	
+	int map_w = min(max(w, 0), 256);
+	int map_h = min(max(h, 0), 256);
+	if (maploc.x < 0 || maploc.y < 0 || maploc.x >= map_w || maploc.y >= map_h) return;
+	
+	int cell = maploc.y * map_w + maploc.x;
+	for (int i=event_cells[cell]; i<event_cells[cell+1]; i++) {
+		if (!events[event_ids[i]].removed)
+			executeEvent(event_ids[i]);
 	}
 }
 
 /**
  * A particular event has been triggered.
- * Process all of this event's components.
+ * Run this event's script; it stops early if a requirement isn't met.
  *
  * @param eid The triggered event id
  */
 void MapIso::executeEvent(int eid) {
-	Event_Component *ec;
-	for (int i=0; i<events[eid].comp_num; i++) {
-		ec = &events[eid].components[i];
-		
-		if (ec->type == "requires_status") {
-			if (!camp->checkStatus(ec->s)) return;
-		}
-		else if (ec->type == "requires_not") {
-			if (camp->checkStatus(ec->s)) return;
-		}
-		else if (ec->type == "requires_item") {
-			if (!camp->checkItem(ec->x)) return;
-		}
-		else if (ec->type == "set_status") {
-			camp->setStatus(ec->s);
-		}
-		else if (ec->type == "unset_status") {
-			camp->unsetStatus(ec->s);
-		}
-		if (ec->type == "intermap") {
+	int pc = event_scripts.entry(events[eid].script);
+	if (event_scripts.run(pc, SCRIPT_RUN, camp, this) == SCRIPT_FAILED) return;
+	
+	if (events[eid].type == ATOM_RUN_ONCE) {
+		events[eid].removed = true;
+	}
+}
+
+/**
+ * The map's part of running event scripts
+ */
+bool MapIso::eventOp(const Event_Op &op, EventScript *script) {
+	switch (op.op) {
+		case OP_INTERMAP:
 			teleportation = true;
-			teleport_mapname = ec->s;
-			teleport_destination.x = ec->x * UNITS_PER_TILE + UNITS_PER_TILE/2;
-			teleport_destination.y = ec->y * UNITS_PER_TILE + UNITS_PER_TILE/2;
-		}
-		else if (ec->type == "mapmod") {
-			if (ec->s == "collision") {
-				collision[ec->x][ec->y] = ec->z;
-				collider.colmap[ec->x][ec->y] = ec->z;
+			teleport_mapname = script->getString(op.s);
+			teleport_destination.x = op.x * UNITS_PER_TILE + UNITS_PER_TILE/2;
+			teleport_destination.y = op.y * UNITS_PER_TILE + UNITS_PER_TILE/2;
+			break;
+		case OP_MAPMOD:
+			if (op.s == MAPMOD_COLLISION) {
+				collider.setTile(op.x, op.y, op.z);
+				collider.clearCache();
+				pathfinder.tileChanged(op.x, op.y);
+				flowfield.invalidate();
+				fov.invalidate();
+				planner.tileChanged(op.x, op.y);
 			}
-			else if (ec->s == "object") {
-				object[ec->x][ec->y] = ec->z;			
+			else if (op.s == MAPMOD_OBJECT) {
+				object[op.x][op.y] = op.z;			
 			}
-			else if (ec->s == "background") {
-				background[ec->x][ec->y] = ec->z;			
+			else if (op.s == MAPMOD_BACKGROUND) {
+				background[op.x][op.y] = op.z;
+				Point changed;
+				changed.x = op.x;
+				changed.y = op.y;
+				background_changed.push_back(changed);
 			}
+			break;
+		case OP_SOUNDFX:
+			playSFX(script->getString(op.s));
+			break;
+		case OP_LOOT: {
+			Event_Component ec;
+			ec.type = ATOM_LOOT;
+			ec.s = script->getString(op.s);
+			ec.x = op.x;
+			ec.y = op.y;
+			ec.z = op.z;
+			loot.push(ec);
+			break;
 		}
-		else if (ec->type == "soundfx") {
-			playSFX(ec->s);
-		}
-		else if (ec->type == "loot") {
-			loot.push(*ec);
-		}
-		else if (ec->type == "msg") {
-			log_msg = ec->s;
-		}
-		else if (ec->type == "shakycam") {
-			shaky_cam_ticks = ec->x;
-		}
-		else if (ec->type == "remove_item") {
-			camp->removeItem(ec->x);
-		}
-		else if (ec->type == "reward_xp") {
-			camp->rewardXP(ec->x);
-		}
-	}
-	if (events[eid].type == "run_once") {
-		removeEvent(eid);
+		case OP_MSG:
+			log_msg = script->getString(op.s);
+			break;
+		case OP_SHAKYCAM:
+			shaky_cam_ticks = op.x;
+			break;
 	}
+	return false;
 }
 
 MapIso::~MapIso() {
@@ -539,5 +755,6 @@ MapIso::~MapIso() {
 		Mix_FreeMusic(music);
 	}
 	if (sfx) Mix_FreeChunk(sfx);
+	if (background_buffer) SDL_FreeSurface(background_buffer);
 }
 
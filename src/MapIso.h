@@ -13,15 +13,21 @@
 #include <fstream>
 #include <string>
 #include <queue>
+#include <vector>
 #include "SDL.h"
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
 #include "TileSet.h"
 #include "MapCollision.h"
+#include "PathFinder.h"
+#include "FlowField.h"
+#include "FieldOfView.h"
+#include "MovePlanner.h"
 #include "Settings.h"
 #include "UtilsParsing.h"
 #include "CampaignManager.h"
+#include "EventScript.h"
 
 using namespace std;
 
@@ -37,15 +43,15 @@ struct Map_NPC {
 };
 
 struct Map_Event {
-	string type;
+	int type; // atom
 	SDL_Rect location;
-	Event_Component components[8];
-	int comp_num;
+	int script; // program in MapIso::event_scripts
+	bool removed; // run_once events that have run stay in the index until the next load
 };
 
 
 
-class MapIso {
+class MapIso : public EventHandler {
 private:
 	SDL_Surface *screen;
 
@@ -56,12 +62,30 @@ private:
 	string sfx_filename;
 	
 	void executeEvent(int eid);
-	void removeEvent(int eid);
 	void playSFX(string filename);
+	
+	// the background layer is kept in an off-screen buffer and reused while scrolling
+	SDL_Surface *background_buffer;
+	Point background_origin;
+	bool background_valid;
+	vector<Point> background_changed; // tiles modified since the last render
+	SDL_Rect tile_bounds; // union of all tile graphics, relative to the tile center
+	
+	void renderBackground(Point origin);
+	void scrollBackground(int dx, int dy);
+	void drawBackground(SDL_Rect area, Point origin);
+	void calcTileBounds();
 		
 	// map events
-	Map_Event events[256];
-	int event_count;
+	vector<Map_Event> events;
+	EventScript event_scripts;
+	
+	// per-tile event index: the ids of the events covering tile (x,y) are
+	// event_ids[event_cells[y*w+x]] up to event_ids[event_cells[y*w+x+1]]
+	vector<int> event_cells;
+	vector<int> event_ids;
+	Point event_tile; // hero tile at the last check
+	void indexEvents();
 	
 public:
 
@@ -79,6 +103,7 @@ public:
 	void render(Renderable r[], int rnum);
 	void checkEvents(Point loc);
 	void clearEvents();
+	bool eventOp(const Event_Op &op, EventScript *script);
 
 	// vars
 	string title;
@@ -95,8 +120,11 @@ public:
 	
 	unsigned short background[256][256];
 	unsigned short object[256][256];
-	unsigned short collision[256][256];
 	MapCollision collider;
+	PathFinder pathfinder;
+	FlowField flowfield;
+	FieldOfView fov;
+	MovePlanner planner;
 
 	// enemy load handling
 	queue<Map_Enemy> enemies;
@@ -66,7 +66,7 @@ void MenuEnemy::render() {
 	if (enemy->stats.maxhp == 0)
 		hp_bar_length = 0;
 	else
-		hp_bar_length = (enemy->stats.hp * 100) / enemy->stats.maxhp;
+		hp_bar_length = (enemy->hp() * 100) / enemy->stats.maxhp;
 
 	// draw hp bar
 	
@@ -84,8 +84,8 @@ void MenuEnemy::render() {
 	ss << enemy->stats.name << " level " << enemy->stats.level;
 	font->render(ss.str(), VIEW_W_HALF, 4, JUSTIFY_CENTER, screen, FONT_WHITE);
 	ss.str("");
-	if (enemy->stats.hp > 0)
-		ss << enemy->stats.hp << "/" << enemy->stats.maxhp;
+	if (enemy->hp() > 0)
+		ss << enemy->hp() << "/" << enemy->stats.maxhp;
 	else
 		ss << "Dead";
 	font->render(ss.str(), VIEW_W_HALF, 19, JUSTIFY_CENTER, screen, FONT_WHITE);
@@ -13,9 +13,6 @@ MenuLog::MenuLog(SDL_Surface *_screen, FontEngine *_font) {
 
 	visible = false;
 	
-	for (int i=0; i<LOG_TYPE_COUNT; i++) {
-		log_count[i] = 0;
-	}
 	active_log = 0;
 	
 	// TODO: move to config file with translation support
@@ -127,7 +124,8 @@ void MenuLog::render() {
 	int total_size = 0;
 
 	// first calculate how many entire messages can fit in the log view
-	for (int i=log_count[active_log]-1; i>=0; i--) {
+	int log_count = log_msg[active_log].size();
+	for (int i=log_count-1; i>=0; i--) {
 		size = font->calc_size(log_msg[active_log][i], list_area.w);
 		total_size += size.y + paragraph_spacing;
 		if (total_size < list_area.h) display_number++;
@@ -136,7 +134,7 @@ void MenuLog::render() {
 	
 	// now display these messages
 	int cursor_y = list_area.y;
-	for (int i=log_count[active_log]-display_number; i<log_count[active_log]; i++) {
+	for (int i=log_count-display_number; i<log_count; i++) {
 		
 		size = font->calc_size(log_msg[active_log][i], list_area.w);	
 		font->render(log_msg[active_log][i], list_area.x, cursor_y, JUSTIFY_LEFT, screen, list_area.w, FONT_WHITE);
@@ -191,20 +189,30 @@ void MenuLog::renderTab(int log_type) {
  */
 void MenuLog::add(string s, int log_type) {
 
-	if (log_count[log_type] == MAX_LOG_MESSAGES) {
+	if ((int)log_msg[log_type].size() == MAX_LOG_MESSAGES) {
 
 		// remove oldest message
-		for (int i=0; i<MAX_LOG_MESSAGES-1; i++) {
-			log_msg[log_type][i] = log_msg[log_type][i+1];
-		}
-
-		log_count[log_type]--;
+		log_msg[log_type].erase(log_msg[log_type].begin());
 	}
 	
 	// add new message
-	log_msg[log_type][log_count[log_type]] = s;
+	log_msg[log_type].push_back(s);
+}
+
+/**
+ * Entries kept in place by their owner (e.g. the quest list) are patched
+ * with these instead of clearing and re-adding the whole tab
+ */
+void MenuLog::insert(int index, string s, int log_type) {
+	log_msg[log_type].insert(log_msg[log_type].begin() + index, s);
+}
+
+void MenuLog::remove(int index, int log_type) {
+	log_msg[log_type].erase(log_msg[log_type].begin() + index);
+}
 
-	log_count[log_type]++;
+void MenuLog::replace(int index, string s, int log_type) {
+	log_msg[log_type][index] = s;
 }
 
 /**
@@ -221,7 +229,7 @@ void MenuLog::clickTab(Point mouse) {
 }
 
 void MenuLog::clear(int log_type) {
-	log_count[log_type] = 0;
+	log_msg[log_type].clear();
 }
 
 void MenuLog::clear() {
@@ -9,13 +9,14 @@
 #define MENU_LOG_H
 
 #include <string>
+#include <vector>
 #include "SDL.h"
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "Utils.h"
 #include "FontEngine.h"
 
-const int MAX_LOG_MESSAGES = 100;
+const int MAX_LOG_MESSAGES = 100; // oldest messages added past this are dropped
 
 const int LOG_TYPE_COUNT = 4;
 const int LOG_TYPE_QUESTS = 0;
@@ -35,8 +36,7 @@ private:
 	void loadGraphics();
 	void renderTab();
 	
-	string log_msg[LOG_TYPE_COUNT][MAX_LOG_MESSAGES];
-	int log_count[LOG_TYPE_COUNT];
+	vector<string> log_msg[LOG_TYPE_COUNT];
 	string tab_labels[LOG_TYPE_COUNT];
 	SDL_Rect tab_rect[LOG_TYPE_COUNT];
 	Point tab_padding;
@@ -51,6 +51,9 @@ public:
 	void render();
 	void renderTab(int log_type);
 	void add(string s, int log_type);
+	void insert(int index, string s, int log_type);
+	void remove(int index, int log_type);
+	void replace(int index, string s, int log_type);
 	void clear(int log_type);
 	void clear();
 	void clickTab(Point mouse);
@@ -28,10 +28,10 @@ void MenuMiniMap::render(MapCollision *collider, Point hero_pos, int map_w, int
 			map_tile.x = hero_tile.x + i - 64;
 			map_tile.y = hero_tile.y + j - 64;
 			if (map_tile.x >= 0 && map_tile.x < map_w && map_tile.y >= 0 && map_tile.y < map_h) {
-				if (collider->colmap[map_tile.x][map_tile.y] == 1) {
+				if (collider->getTile(map_tile.x, map_tile.y) == BLOCKS_ALL) {
 					drawPixel(screen, VIEW_W - 128 + i, 16+j, color_wall);
 				}
-				else if (collider->colmap[map_tile.x][map_tile.y] == 2) {
+				else if (collider->getTile(map_tile.x, map_tile.y) == BLOCKS_MOVEMENT) {
 					drawPixel(screen, VIEW_W - 128 + i, 16+j, color_obst);
 				}
 			}
@@ -92,8 +92,8 @@ void MenuTalker::render() {
 	SDL_BlitSurface(background, &src, screen, &dest);
 	
 	// show active portrait
-	string etype = npc->dialog[dialog_node][event_cursor].type;
-	if (etype == "him" || etype == "her") {
+	const Event_Op &op = npc->getDialogOp(dialog_node, event_cursor);
+	if (op.op == OP_SAY_HIM || op.op == OP_SAY_HER) {
 		if (npc->portrait != NULL) {
 			src.w = dest.w = 320;
 			src.h = dest.h = 320;
@@ -103,14 +103,14 @@ void MenuTalker::render() {
 		}
 		line = npc->name + ": ";
 	}
-	else if (etype == "you") {
+	else if (op.op == OP_SAY_YOU) {
 		// TODO: display the player's chosen portrait
 		// TODO: display the player's chosen name
 		line = "You: ";
 	}
 	
 	// text overlay
-	line = line + npc->dialog[dialog_node][event_cursor].s;
+	line = line + npc->dialog.getString(op.s);
 	font->render(line, offset_x+48, offset_y+336, JUSTIFY_LEFT, screen, 544, FONT_WHITE);
 }
 
@@ -0,0 +1,289 @@
+/**
+ * class MovePlanner
+ *
+ * Click-to-move route planning for the hero (D* Lite).
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "MovePlanner.h"
+#include "PathFinder.h"
+
+const int PLANNER_INF = 0x3fffffff;
+
+MovePlanner::MovePlanner() {
+	collider = NULL;
+	map_size.x = map_size.y = 0;
+	goal.x = goal.y = -1;
+	last_start.x = last_start.y = -1;
+	active = false;
+	km = 0;
+	generation = 0;
+}
+
+/**
+ * Size the search for the collider's current map
+ */
+void MovePlanner::init(MapCollision *_collider) {
+	collider = _collider;
+	map_size = collider->map_size;
+	int count = map_size.x * map_size.y;
+	stamp.assign(count, 0);
+	g.assign(count, PLANNER_INF);
+	rhs.assign(count, PLANNER_INF);
+	open_key.assign(count, Planner_Key());
+	in_open.assign(count, false);
+	open = priority_queue<Planner_Open>();
+	generation = 0;
+	active = false;
+}
+
+bool MovePlanner::walkable(int x, int y) {
+	return !collider->tile_blocks(x, y, CHECK_MOVEMENT);
+}
+
+/**
+ * Cost of stepping between two neighbouring tiles
+ */
+int MovePlanner::cost(int x1, int y1, int x2, int y2) {
+	if (!walkable(x1, y1) || !walkable(x2, y2)) return PLANNER_INF;
+	if (x1 != x2 && y1 != y2) {
+		// don't cut corners
+		if (!walkable(x2, y1) || !walkable(x1, y2)) return PLANNER_INF;
+		return PATH_COST_DIAGONAL;
+	}
+	return PATH_COST_STRAIGHT;
+}
+
+int MovePlanner::heuristic(int x1, int y1, int x2, int y2) {
+	int dx = abs(x1 - x2);
+	int dy = abs(y1 - y2);
+	return PATH_COST_STRAIGHT * max(dx, dy) + (PATH_COST_DIAGONAL - PATH_COST_STRAIGHT) * min(dx, dy);
+}
+
+/**
+ * Tiles not seen by the current search start out unexplored
+ */
+void MovePlanner::touch(int index) {
+	if (stamp[index] == generation) return;
+	stamp[index] = generation;
+	g[index] = PLANNER_INF;
+	rhs[index] = PLANNER_INF;
+	in_open[index] = false;
+}
+
+Planner_Key MovePlanner::calcKey(int index, Point start) {
+	Planner_Key key;
+	key.k2 = min(g[index], rhs[index]);
+	if (key.k2 == PLANNER_INF) {
+		key.k1 = PLANNER_INF;
+	}
+	else {
+		key.k1 = key.k2 + km + heuristic(index % map_size.x, index / map_size.x, start.x, start.y);
+	}
+	return key;
+}
+
+void MovePlanner::updateVertex(int index, Point start) {
+	touch(index);
+	int x = index % map_size.x;
+	int y = index / map_size.x;
+
+	if (x != goal.x || y != goal.y) {
+		int best = PLANNER_INF;
+		for (int dy=-1; dy<=1; dy++) {
+			for (int dx=-1; dx<=1; dx++) {
+				if (dx == 0 && dy == 0) continue;
+				if (collider->outsideMap(x+dx, y+dy)) continue;
+				int c = cost(x, y, x+dx, y+dy);
+				if (c == PLANNER_INF) continue;
+				int n = (y+dy) * map_size.x + (x+dx);
+				touch(n);
+				if (g[n] != PLANNER_INF && g[n] + c < best) best = g[n] + c;
+			}
+		}
+		rhs[index] = best;
+	}
+
+	// the queue is lazy: stale entries are skipped when they surface
+	in_open[index] = false;
+	if (g[index] != rhs[index]) {
+		Planner_Open entry;
+		entry.key = calcKey(index, start);
+		entry.tile = index;
+		open_key[index] = entry.key;
+		in_open[index] = true;
+		open.push(entry);
+	}
+}
+
+/**
+ * Smallest live key on the open list
+ */
+bool MovePlanner::topKey(Planner_Key &key) {
+	while (!open.empty()) {
+		const Planner_Open &entry = open.top();
+		if (stamp[entry.tile] == generation && in_open[entry.tile] && open_key[entry.tile] == entry.key) {
+			key = entry.key;
+			return true;
+		}
+		open.pop();
+	}
+	return false;
+}
+
+/**
+ * Expand tiles until the hero's tile has its final distance
+ *
+ * @return false if the expansion budget ran out first
+ */
+bool MovePlanner::computePath(Point start) {
+	int s = start.y * map_size.x + start.x;
+	Planner_Key top;
+	int expansions = 0;
+
+	while (true) {
+		touch(s);
+		bool has_top = topKey(top);
+		if (!has_top) return true;
+		if (!(top < calcKey(s, start)) && rhs[s] == g[s]) return true;
+		if (++expansions > PLANNER_MAX_EXPANSIONS) return false;
+
+		int u = open.top().tile;
+		open.pop();
+		in_open[u] = false;
+
+		Planner_Key key = calcKey(u, start);
+		if (top < key) {
+			Planner_Open entry;
+			entry.key = key;
+			entry.tile = u;
+			open_key[u] = key;
+			in_open[u] = true;
+			open.push(entry);
+			continue;
+		}
+
+		if (g[u] > rhs[u]) {
+			g[u] = rhs[u];
+		}
+		else {
+			g[u] = PLANNER_INF;
+			updateVertex(u, start);
+		}
+
+		int x = u % map_size.x;
+		int y = u / map_size.x;
+		for (int dy=-1; dy<=1; dy++) {
+			for (int dx=-1; dx<=1; dx++) {
+				if (dx == 0 && dy == 0) continue;
+				if (collider->outsideMap(x+dx, y+dy)) continue;
+				updateVertex((y+dy) * map_size.x + (x+dx), start);
+			}
+		}
+	}
+}
+
+/**
+ * Start a new search towards this tile
+ */
+void MovePlanner::reset(Point _goal) {
+	generation++;
+	open = priority_queue<Planner_Open>();
+	km = 0;
+	goal = _goal;
+	active = true;
+
+	int index = goal.y * map_size.x + goal.x;
+	touch(index);
+	rhs[index] = 0;
+	updateVertex(index, last_start);
+}
+
+/**
+ * A collision tile was changed by a map event.
+ * Edges to the tile and the diagonals cutting its corners are repaired lazily.
+ */
+void MovePlanner::tileChanged(int x, int y) {
+	if (!active || collider == NULL) return;
+	for (int dy=-1; dy<=1; dy++) {
+		for (int dx=-1; dx<=1; dx++) {
+			if (collider->outsideMap(x+dx, y+dy)) continue;
+			updateVertex((y+dy) * map_size.x + (x+dx), last_start);
+		}
+	}
+}
+
+/**
+ * Where the hero at pos should walk next on the way to target.
+ * The route is followed as far ahead as a straight walk is possible.
+ *
+ * @param next Receives the point to head for, in map units
+ * @return false when there is no route (yet); head straight for the target
+ */
+bool MovePlanner::nextStep(Point pos, Point target, Point &next) {
+	if (collider == NULL) return false;
+
+	Point start;
+	Point dest;
+	start.x = pos.x >> TILE_SHIFT;
+	start.y = pos.y >> TILE_SHIFT;
+	dest.x = target.x >> TILE_SHIFT;
+	dest.y = target.y >> TILE_SHIFT;
+	if (!walkable(start.x, start.y) || !walkable(dest.x, dest.y)) return false;
+	if (start.x == dest.x && start.y == dest.y) return false;
+
+	if (!active || dest.x != goal.x || dest.y != goal.y) {
+		last_start = start;
+		reset(dest);
+	}
+	else if (start.x != last_start.x || start.y != last_start.y) {
+		km += heuristic(last_start.x, last_start.y, start.x, start.y);
+		last_start = start;
+	}
+
+	if (!computePath(start)) return false;
+	if (rhs[start.y * map_size.x + start.x] == PLANNER_INF) return false;
+
+	// follow the cheapest neighbours, skipping ahead while the walk stays straight
+	Point cur = start;
+	bool found = false;
+	for (int step=0; step<PLANNER_LOOKAHEAD; step++) {
+		if (cur.x == goal.x && cur.y == goal.y) {
+			if (collider->line_of_movement(pos.x, pos.y, target.x, target.y)) next = target;
+			break;
+		}
+
+		Point best_tile = cur;
+		int best = PLANNER_INF;
+		for (int dy=-1; dy<=1; dy++) {
+			for (int dx=-1; dx<=1; dx++) {
+				if (dx == 0 && dy == 0) continue;
+				if (collider->outsideMap(cur.x+dx, cur.y+dy)) continue;
+				int c = cost(cur.x, cur.y, cur.x+dx, cur.y+dy);
+				if (c == PLANNER_INF) continue;
+				int n = (cur.y+dy) * map_size.x + (cur.x+dx);
+				touch(n);
+				if (g[n] != PLANNER_INF && g[n] + c < best) {
+					best = g[n] + c;
+					best_tile.x = cur.x + dx;
+					best_tile.y = cur.y + dy;
+				}
+			}
+		}
+		if (best == PLANNER_INF) break;
+
+		Point center;
+		center.x = best_tile.x * UNITS_PER_TILE + UNITS_PER_TILE/2;
+		center.y = best_tile.y * UNITS_PER_TILE + UNITS_PER_TILE/2;
+		if (step > 0 && !collider->line_of_movement(pos.x, pos.y, center.x, center.y)) break;
+		next = center;
+		cur = best_tile;
+		found = true;
+	}
+	return found;
+}
+
+MovePlanner::~MovePlanner() {
+}
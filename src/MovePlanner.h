@@ -0,0 +1,91 @@
+/**
+ * class MovePlanner
+ *
+ * Click-to-move route planning for the hero (D* Lite).
+ *
+ * The search is rooted at the clicked tile and grows towards the hero.
+ * As the hero walks, or when map events change the collision layer, only
+ * the affected part of the search is repaired instead of starting over.
+ * A new search starts only when the target moves into another tile.
+ * Expansions are budgeted per call, so a long search is spread over a few
+ * frames.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef MOVE_PLANNER_H
+#define MOVE_PLANNER_H
+
+#include <vector>
+#include <queue>
+#include "Utils.h"
+#include "MapCollision.h"
+
+using namespace std;
+
+// most tiles expanded per call to nextStep
+const int PLANNER_MAX_EXPANSIONS = 2048;
+
+// how many tiles ahead of the hero the route is straightened
+const int PLANNER_LOOKAHEAD = 8;
+
+struct Planner_Key {
+	int k1;
+	int k2;
+	bool operator<(const Planner_Key &other) const {
+		if (k1 != other.k1) return k1 < other.k1;
+		return k2 < other.k2;
+	}
+	bool operator==(const Planner_Key &other) const {
+		return k1 == other.k1 && k2 == other.k2;
+	}
+};
+
+struct Planner_Open {
+	Planner_Key key;
+	int tile;
+	// reversed so the priority queue pops the smallest key
+	bool operator<(const Planner_Open &other) const {
+		return other.key < key;
+	}
+};
+
+class MovePlanner {
+private:
+	MapCollision *collider;
+	Point map_size;
+	Point goal;
+	Point last_start;
+	bool active;
+	int km;
+
+	// per tile search state; only current when the stamp matches generation
+	int generation;
+	vector<int> stamp;
+	vector<int> g;
+	vector<int> rhs;
+	vector<Planner_Key> open_key;
+	vector<bool> in_open;
+	priority_queue<Planner_Open> open;
+
+	bool walkable(int x, int y);
+	int cost(int x1, int y1, int x2, int y2);
+	int heuristic(int x1, int y1, int x2, int y2);
+	void touch(int index);
+	Planner_Key calcKey(int index, Point start);
+	void updateVertex(int index, Point start);
+	bool topKey(Planner_Key &key);
+	bool computePath(Point start);
+	void reset(Point _goal);
+
+public:
+	MovePlanner();
+	~MovePlanner();
+
+	void init(MapCollision *_collider);
+	void tileChanged(int x, int y);
+	bool nextStep(Point pos, Point target, Point &next);
+};
+
+#endif
@@ -37,15 +37,7 @@ NPC::NPC(MapIso *_map, ItemDatabase *_items) : Entity(_map) {
 	portrait = NULL;
 	talker = false;
 
-	for (int i=0; i<NPC_MAX_DIALOG; i++) {
-		for (int j=0; j<NPC_MAX_EVENTS; j++) {
-			dialog[i][j].type = "";
-			dialog[i][j].s = "";
-			dialog[i][j].x = 0;
-			dialog[i][j].y = 0;
-			dialog[i][j].z = 0;
-		}
-	}
+	dialog.clear();
 	dialog_count = 0;
 }
 
@@ -63,7 +55,6 @@ void NPC::load(string npc_id) {
 	string starts_with;
 	string section = "";
 	ItemStack stack;
-	int event_count = 0;
 	
 	infile.open(("npcs/" + npc_id + ".txt").c_str(), ios::in);
 
@@ -83,8 +74,8 @@ void NPC::load(string npc_id) {
 				else if (starts_with == "[") {
 					section = parse_section_title(line);
 					if (section == "dialog") {
+						dialog.beginProgram();
 						dialog_count++;
-						event_count = 0;
 					}
 				}
 				else { // this is data.  treatment depends on key
@@ -94,36 +85,35 @@ void NPC::load(string npc_id) {
 				
 					if (section == "dialog") {
 					
-						// here we use dialog_count-1 because we've already incremented the dialog count but the array is 0 based
-					
-						dialog[dialog_count-1][event_count].type = key;
+						Event_Component ec;
+						ec.type = atom(key);
 						if (key == "requires_status")
-							dialog[dialog_count-1][event_count].s = val;
+							ec.s = val;
 						else if (key == "requires_not")
-							dialog[dialog_count-1][event_count].s = val;
+							ec.s = val;
 						else if (key == "requires_item")
-							dialog[dialog_count-1][event_count].x = atoi(val.c_str());
+							ec.x = atoi(val.c_str());
 						else if (key == "him" || key == "her")
-							dialog[dialog_count-1][event_count].s = val;
+							ec.s = val;
 						else if (key == "you")
-							dialog[dialog_count-1][event_count].s = val;
+							ec.s = val;
 						else if (key == "reward_item") {
 							// id,count
-							dialog[dialog_count-1][event_count].x = eatFirstInt(val, ',');
-							dialog[dialog_count-1][event_count].y = atoi(val.c_str());							
+							ec.x = eatFirstInt(val, ',');
+							ec.y = atoi(val.c_str());							
 						}
 						else if (key == "reward_xp")
-							dialog[dialog_count-1][event_count].x = atoi(val.c_str());
+							ec.x = atoi(val.c_str());
 						else if (key == "reward_currency")
-							dialog[dialog_count-1][event_count].x = atoi(val.c_str());
+							ec.x = atoi(val.c_str());
 						else if (key == "remove_item")
-							dialog[dialog_count-1][event_count].x = atoi(val.c_str());
+							ec.x = atoi(val.c_str());
 						else if (key == "set_status")
-							dialog[dialog_count-1][event_count].s = val;
+							ec.s = val;
 						else if (key == "unset_status")
-							dialog[dialog_count-1][event_count].s = val;						
+							ec.s = val;						
 						
-						event_count++;
+						dialog.add(ec);
 					}
 					else {
 						if (key == "name") {
@@ -200,9 +190,7 @@ void NPC::loadGraphics(string filename_sprites, string filename_portrait) {
 		SDL_SetColorKey( sprites, SDL_SRCCOLORKEY, SDL_MapRGB(sprites->format, 255, 0, 255) );
 	
 		// optimize
-		SDL_Surface *cleanup = sprites;
-		sprites = SDL_DisplayFormatAlpha(sprites);
-		SDL_FreeSurface(cleanup);
+		sprites = optimizeSurface(sprites);
 	}
 	if (filename_portrait != "") {
 		portrait = IMG_Load(("images/portraits/" + filename_portrait + ".png").c_str());
@@ -274,25 +262,8 @@ int NPC::chooseDialogNode() {
 	// First node we reach that meets requirements is the correct node
 	
 	for (int i=dialog_count-1; i>=0; i--) {
-		for (int j=0; j<NPC_MAX_EVENTS; j++) {
-			
-			// check requirements
-			// break (skip to next dialog node) if any requirement fails
-			// if we reach an event that is not a requirement, succeed
-			
-			if (dialog[i][j].type == "requires_status") {
-				if (!map->camp->checkStatus(dialog[i][j].s)) break;
-			}
-			else if (dialog[i][j].type == "requires_not") {
-				if (map->camp->checkStatus(dialog[i][j].s)) break;
-			}
-			else if (dialog[i][j].type == "requires_item") {
-				if (!map->camp->checkItem(dialog[i][j].x)) break;
-			}
-			else {
-				return i;
-			}
-		}
+		if (dialog.run(dialog.entry(i), SCRIPT_CHECK, map->camp, this) != SCRIPT_FAILED)
+			return i;
 	}
 	return 0;
 }
@@ -300,64 +271,32 @@ int NPC::chooseDialogNode() {
 
 /**
  * Process the current dialog
+ * Requirements were met when the node was chosen, so they're skipped here.
+ * Stops at the next line of dialog, leaving event_cursor on it.
  *
  * Return false if the dialog has ended
  */
 bool NPC::processDialog(int dialog_node, int &event_cursor) {
-
-	stringstream ss;
-	ss.str("");
-	
-	while (event_cursor < NPC_MAX_EVENTS) {
+	int start = dialog.entry(dialog_node);
+	int pc = dialog.run(start + event_cursor, SCRIPT_RESUME, map->camp, this);
+	event_cursor = pc - start;
 	
-		// we've already determined requirements are met, so skip these
-		if (dialog[dialog_node][event_cursor].type == "requires_status") {
-			// continue to next event component
-		}
-		else if (dialog[dialog_node][event_cursor].type == "requires_not") {
-			// continue to next event component
-		}
-		else if (dialog[dialog_node][event_cursor].type == "requires_item") {
-			// continue to next event component	
-		}
-		else if (dialog[dialog_node][event_cursor].type == "set_status") {
-			map->camp->setStatus(dialog[dialog_node][event_cursor].s);
-		}
-		else if (dialog[dialog_node][event_cursor].type == "unset_status") {
-			map->camp->unsetStatus(dialog[dialog_node][event_cursor].s);
-		}
-		else if (dialog[dialog_node][event_cursor].type == "him") {
-			return true;
-		}
-		else if (dialog[dialog_node][event_cursor].type == "her") {
-			return true;
-		}
-		else if (dialog[dialog_node][event_cursor].type == "you") {
-			return true;
-		}
-		else if (dialog[dialog_node][event_cursor].type == "reward_xp") {
-			map->camp->rewardXP(dialog[dialog_node][event_cursor].x);
-		}
-		else if (dialog[dialog_node][event_cursor].type == "reward_currency") {
-			map->camp->rewardCurrency(dialog[dialog_node][event_cursor].x);
-		}
-		else if (dialog[dialog_node][event_cursor].type == "reward_item") {
-			ItemStack istack;
-			istack.item = dialog[dialog_node][event_cursor].x;
-			istack.quantity = dialog[dialog_node][event_cursor].y;
-			map->camp->rewardItem(istack);
-		}
-		else if (dialog[dialog_node][event_cursor].type == "remove_item") {
-			map->camp->removeItem(dialog[dialog_node][event_cursor].x);
-		}
-		else if (dialog[dialog_node][event_cursor].type == "") {
-			// conversation ends
-			return false;
-		}
-		
-		event_cursor++;
-	}
-	return false;
+	// conversation ends
+	return dialog.getOp(pc).op != OP_END;
+}
+
+/**
+ * The dialog op at event_cursor in this node
+ */
+const Event_Op &NPC::getDialogOp(int dialog_node, int event_cursor) {
+	return dialog.getOp(dialog.entry(dialog_node) + event_cursor);
+}
+
+/**
+ * Lines of dialog pause the script until the player continues
+ */
+bool NPC::eventOp(const Event_Op &op, EventScript *) {
+	return op.op == OP_SAY_HIM || op.op == OP_SAY_HER || op.op == OP_SAY_YOU;
 }
 
 /**
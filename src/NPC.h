@@ -19,6 +19,7 @@
 #include "ItemDatabase.h"
 #include "ItemStorage.h"
 #include "MapIso.h"
+#include "EventScript.h"
 
 using namespace std;
 
@@ -26,10 +27,8 @@ const int NPC_VENDOR_MAX_STOCK = 80;
 const int NPC_MAX_VOX = 8;
 const int NPC_VOX_INTRO = 0;
 
-const int NPC_MAX_DIALOG = 32;
-const int NPC_MAX_EVENTS = 16;
 
-class NPC : public Entity {
+class NPC : public Entity, public EventHandler {
 protected:
 	ItemDatabase *items;
 
@@ -49,6 +48,8 @@ public:
 	bool playSound(int type);
 	int chooseDialogNode();
 	bool processDialog(int dialog_node, int &event_cursor);
+	const Event_Op &getDialogOp(int dialog_node, int event_cursor);
+	bool eventOp(const Event_Op &op, EventScript *script);
 	virtual Renderable getRender();
 	
 	// general info
@@ -74,8 +75,8 @@ public:
 	Mix_Chunk *vox_intro[NPC_MAX_VOX];
 	int vox_intro_count;
 	
-	// story and dialog options
-	Event_Component dialog[NPC_MAX_DIALOG][NPC_MAX_EVENTS];
+	// story and dialog options, one program per dialog node
+	EventScript dialog;
 	int dialog_count;
 	
 };
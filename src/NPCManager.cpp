@@ -37,6 +37,8 @@ void NPCManager::handleNewMap() {
 	}
 	
 	npc_count = 0;
+	grid.init(map->w, map->h);
+	max_render_size.x = max_render_size.y = 0;
 	
 	// read the queued NPCs in the map file
 	while (!map->npcs.empty()) {
@@ -57,6 +59,9 @@ void NPCManager::handleNewMap() {
 		}
 		npcs[npc_count]->stock.sort();
 
+		grid.insert(npc_count, npcs[npc_count]->pos);
+		max_render_size.x = max(max_render_size.x, npcs[npc_count]->render_size.x);
+		max_render_size.y = max(max_render_size.y, npcs[npc_count]->render_size.y);
 		npc_count++;
 	}
 
@@ -68,10 +73,24 @@ void NPCManager::logic() {
 	}
 }
 
+/**
+ * Gather the NPCs standing close enough on screen to be under the mouse
+ */
+void NPCManager::findNear(Point mouse, Point cam) {
+	SDL_Rect r;
+	r.x = mouse.x - max_render_size.x;
+	r.y = mouse.y - max_render_size.y;
+	r.w = max_render_size.x * 2;
+	r.h = max_render_size.y * 2;
+	grid.queryScreen(r, cam, found);
+}
+
 int NPCManager::checkNPCClick(Point mouse, Point cam) {
 	Point p;
 	SDL_Rect r;
-	for(int i=0; i<npc_count; i++) {
+	findNear(mouse, cam);
+	for (unsigned k=0; k<found.size(); k++) {
+		int i = found[k];
 
 		p = map_to_screen(npcs[i]->pos.x, npcs[i]->pos.y, cam.x, cam.y);
 	
@@ -95,7 +114,9 @@ void NPCManager::renderTooltips(Point cam, Point mouse) {
 	SDL_Rect r;
 	TooltipData td;
 	
-	for(int i=0; i<npc_count; i++) {
+	findNear(mouse, cam);
+	for (unsigned k=0; k<found.size(); k++) {
+		int i = found[k];
 
 		p = map_to_screen(npcs[i]->pos.x, npcs[i]->pos.y, cam.x, cam.y);
 	
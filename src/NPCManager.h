@@ -19,6 +19,7 @@
 #include "MapIso.h"
 #include "MenuTooltip.h"
 #include "LootManager.h"
+#include "SpatialHash.h"
 
 using namespace std;
 
@@ -31,6 +32,12 @@ private:
 	MenuTooltip *tip;
 	LootManager *loot;
 	ItemDatabase *items;
+	
+	// npc indices by position
+	SpatialHash grid;
+	Point max_render_size;
+	vector<int> found;
+	void findNear(Point mouse, Point cam);
 public:
 	NPCManager(MapIso *_map, MenuTooltip *_tip, LootManager *_loot, ItemDatabase *_items);
 	~NPCManager();
@@ -0,0 +1,518 @@
+/**
+ * class PathFinder
+ *
+ * Hierarchical pathfinding (HPA*) on the collision layer.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "PathFinder.h"
+#include <queue>
+#include <algorithm>
+
+const int PATH_UNREACHABLE = 0x3fffffff;
+
+// open list entries are (cost, id); greater<> turns the queue into a min-heap
+typedef pair<int, int> Path_Open;
+typedef priority_queue<Path_Open, vector<Path_Open>, greater<Path_Open> > Path_Queue;
+
+PathFinder::PathFinder() {
+	collider = NULL;
+	map_size.x = map_size.y = 0;
+	clusters.x = clusters.y = 0;
+	queries_left = PATH_QUERIES_PER_FRAME;
+	local_rect.x = local_rect.y = local_rect.w = local_rect.h = 0;
+}
+
+/**
+ * Build the cluster graph for the collider's current map
+ * Call after the collision layer and map size are set
+ */
+void PathFinder::init(MapCollision *_collider) {
+	collider = _collider;
+	map_size = collider->map_size;
+	clusters.x = (map_size.x + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+	clusters.y = (map_size.y + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+	int count = clusters.x * clusters.y;
+
+	nodes.clear();
+	free_nodes.clear();
+	tile_node.assign(map_size.x * map_size.y, -1);
+	cluster_nodes.assign(count, vector<int>());
+	east_entrances.assign(count, vector<Path_Entrance>());
+	south_entrances.assign(count, vector<Path_Entrance>());
+
+	for (int c=0; c<count; c++) {
+		buildEntrances(c, true);
+		buildEntrances(c, false);
+	}
+	for (int c=0; c<count; c++) {
+		buildEdges(c);
+	}
+	queries_left = PATH_QUERIES_PER_FRAME;
+}
+
+void PathFinder::beginFrame() {
+	queries_left = PATH_QUERIES_PER_FRAME;
+}
+
+bool PathFinder::walkable(int x, int y) {
+	return !collider->tile_blocks(x, y, CHECK_MOVEMENT);
+}
+
+int PathFinder::clusterOf(int x, int y) {
+	return (y / PATH_CLUSTER_SIZE) * clusters.x + (x / PATH_CLUSTER_SIZE);
+}
+
+SDL_Rect PathFinder::clusterRect(int cluster) {
+	SDL_Rect r;
+	r.x = (cluster % clusters.x) * PATH_CLUSTER_SIZE;
+	r.y = (cluster / clusters.x) * PATH_CLUSTER_SIZE;
+	r.w = min(PATH_CLUSTER_SIZE, map_size.x - r.x);
+	r.h = min(PATH_CLUSTER_SIZE, map_size.y - r.y);
+	return r;
+}
+
+/**
+ * Get the node on this tile, creating it if needed
+ */
+int PathFinder::addNode(Point tile) {
+	int index = tile.y * map_size.x + tile.x;
+	int id = tile_node[index];
+	if (id != -1) {
+		nodes[id].refs++;
+		return id;
+	}
+
+	if (!free_nodes.empty()) {
+		id = free_nodes.back();
+		free_nodes.pop_back();
+	}
+	else {
+		id = nodes.size();
+		nodes.push_back(Path_Node());
+	}
+	nodes[id].tile = tile;
+	nodes[id].cluster = clusterOf(tile.x, tile.y);
+	nodes[id].refs = 1;
+	nodes[id].edges.clear();
+	tile_node[index] = id;
+	cluster_nodes[nodes[id].cluster].push_back(id);
+	return id;
+}
+
+/**
+ * Drop one reference to a node; unused nodes are unlinked and recycled
+ */
+void PathFinder::releaseNode(int id) {
+	if (--nodes[id].refs > 0) return;
+
+	for (unsigned i=0; i<nodes[id].edges.size(); i++) {
+		removeEdge(nodes[id].edges[i].to, id);
+	}
+	nodes[id].edges.clear();
+	tile_node[nodes[id].tile.y * map_size.x + nodes[id].tile.x] = -1;
+
+	vector<int> &members = cluster_nodes[nodes[id].cluster];
+	members.erase(find(members.begin(), members.end(), id));
+	free_nodes.push_back(id);
+}
+
+void PathFinder::removeEdge(int from, int to) {
+	vector<Path_Edge> &edges = nodes[from].edges;
+	for (unsigned i=0; i<edges.size(); i++) {
+		if (edges[i].to == to) {
+			edges.erase(edges.begin() + i);
+			return;
+		}
+	}
+}
+
+/**
+ * Find the entrances on the east or south border of a cluster.
+ * Each maximal run of open tile pairs gets one entrance in its middle,
+ * or one at each end when the run is long.
+ */
+void PathFinder::buildEntrances(int cluster, bool east) {
+	SDL_Rect r = clusterRect(cluster);
+	int length;
+	Point near;
+	Point far;
+
+	if (east) {
+		if (r.x + r.w >= map_size.x) return;
+		length = r.h;
+	}
+	else {
+		if (r.y + r.h >= map_size.y) return;
+		length = r.w;
+	}
+
+	vector<Path_Entrance> &entrances = east ? east_entrances[cluster] : south_entrances[cluster];
+	int run_start = -1;
+
+	// one extra step closes a run that reaches the end of the border
+	for (int k=0; k<=length; k++) {
+		bool open = false;
+		if (k < length) {
+			if (east) {
+				open = walkable(r.x + r.w - 1, r.y + k) && walkable(r.x + r.w, r.y + k);
+			}
+			else {
+				open = walkable(r.x + k, r.y + r.h - 1) && walkable(r.x + k, r.y + r.h);
+			}
+		}
+
+		if (open && run_start == -1) {
+			run_start = k;
+		}
+		else if (!open && run_start != -1) {
+			int run_end = k - 1;
+			int picks[2];
+			int pick_count = 0;
+			if (run_end - run_start + 1 >= PATH_CLUSTER_SIZE / 2) {
+				picks[pick_count++] = run_start;
+				picks[pick_count++] = run_end;
+			}
+			else {
+				picks[pick_count++] = (run_start + run_end) / 2;
+			}
+
+			for (int p=0; p<pick_count; p++) {
+				if (east) {
+					near.x = r.x + r.w - 1;
+					near.y = r.y + picks[p];
+					far.x = near.x + 1;
+					far.y = near.y;
+				}
+				else {
+					near.x = r.x + picks[p];
+					near.y = r.y + r.h - 1;
+					far.x = near.x;
+					far.y = near.y + 1;
+				}
+
+				Path_Entrance e;
+				e.a = addNode(near);
+				e.b = addNode(far);
+
+				Path_Edge edge;
+				edge.cost = PATH_COST_STRAIGHT;
+				edge.inter = true;
+				edge.to = e.b;
+				nodes[e.a].edges.push_back(edge);
+				edge.to = e.a;
+				nodes[e.b].edges.push_back(edge);
+
+				entrances.push_back(e);
+			}
+			run_start = -1;
+		}
+	}
+}
+
+void PathFinder::clearEntrances(int cluster, bool east) {
+	vector<Path_Entrance> &entrances = east ? east_entrances[cluster] : south_entrances[cluster];
+	for (unsigned i=0; i<entrances.size(); i++) {
+		removeEdge(entrances[i].a, entrances[i].b);
+		removeEdge(entrances[i].b, entrances[i].a);
+		releaseNode(entrances[i].a);
+		releaseNode(entrances[i].b);
+	}
+	entrances.clear();
+}
+
+/**
+ * Link every pair of nodes in a cluster by their walking distance inside it
+ */
+void PathFinder::buildEdges(int cluster) {
+	vector<int> &members = cluster_nodes[cluster];
+
+	// drop the old links inside this cluster
+	for (unsigned i=0; i<members.size(); i++) {
+		vector<Path_Edge> &edges = nodes[members[i]].edges;
+		for (unsigned j=0; j<edges.size(); ) {
+			if (!edges[j].inter) edges.erase(edges.begin() + j);
+			else j++;
+		}
+	}
+
+	for (unsigned i=0; i<members.size(); i++) {
+		searchCluster(nodes[members[i]].tile, cluster);
+		for (unsigned j=0; j<members.size(); j++) {
+			if (i == j) continue;
+			int cost = localCost(nodes[members[j]].tile);
+			if (cost == PATH_UNREACHABLE) continue;
+
+			Path_Edge edge;
+			edge.to = members[j];
+			edge.cost = cost;
+			edge.inter = false;
+			nodes[members[i]].edges.push_back(edge);
+		}
+	}
+}
+
+/**
+ * Rebuild a cluster and the borders it shares with its neighbours
+ */
+void PathFinder::rebuild(int cluster) {
+	int cx = cluster % clusters.x;
+	int cy = cluster / clusters.x;
+	int west = (cx > 0) ? cluster - 1 : -1;
+	int north = (cy > 0) ? cluster - clusters.x : -1;
+	int east = (cx < clusters.x - 1) ? cluster + 1 : -1;
+	int south = (cy < clusters.y - 1) ? cluster + clusters.x : -1;
+
+	clearEntrances(cluster, true);
+	clearEntrances(cluster, false);
+	if (west != -1) clearEntrances(west, true);
+	if (north != -1) clearEntrances(north, false);
+
+	buildEntrances(cluster, true);
+	buildEntrances(cluster, false);
+	if (west != -1) buildEntrances(west, true);
+	if (north != -1) buildEntrances(north, false);
+
+	buildEdges(cluster);
+	if (west != -1) buildEdges(west);
+	if (north != -1) buildEdges(north);
+	if (east != -1) buildEdges(east);
+	if (south != -1) buildEdges(south);
+}
+
+/**
+ * A collision tile was changed by a map event
+ */
+void PathFinder::tileChanged(int x, int y) {
+	if (collider == NULL || x < 0 || y < 0 || x >= map_size.x || y >= map_size.y) return;
+	rebuild(clusterOf(x, y));
+}
+
+/**
+ * Dijkstra from one tile, limited to a single cluster.
+ * Results are read back with localCost() and local_parent.
+ */
+void PathFinder::searchCluster(Point from, int cluster) {
+	local_rect = clusterRect(cluster);
+	int count = local_rect.w * local_rect.h;
+	for (int i=0; i<count; i++) {
+		local_cost[i] = PATH_UNREACHABLE;
+		local_parent[i] = -1;
+	}
+
+	int start = (from.y - local_rect.y) * local_rect.w + (from.x - local_rect.x);
+	if (!walkable(from.x, from.y)) return;
+
+	Path_Queue open;
+	local_cost[start] = 0;
+	open.push(Path_Open(0, start));
+
+	while (!open.empty()) {
+		int cost = open.top().first;
+		int cur = open.top().second;
+		open.pop();
+		if (cost > local_cost[cur]) continue;
+
+		int x = local_rect.x + cur % local_rect.w;
+		int y = local_rect.y + cur / local_rect.w;
+
+		for (int dy=-1; dy<=1; dy++) {
+			for (int dx=-1; dx<=1; dx++) {
+				if (dx == 0 && dy == 0) continue;
+				int nx = x + dx;
+				int ny = y + dy;
+				if (nx < local_rect.x || ny < local_rect.y || nx >= local_rect.x + local_rect.w || ny >= local_rect.y + local_rect.h) continue;
+				if (!walkable(nx, ny)) continue;
+
+				int step = PATH_COST_STRAIGHT;
+				if (dx != 0 && dy != 0) {
+					// don't cut corners
+					if (!walkable(x + dx, y) || !walkable(x, y + dy)) continue;
+					step = PATH_COST_DIAGONAL;
+				}
+
+				int next = (ny - local_rect.y) * local_rect.w + (nx - local_rect.x);
+				if (cost + step < local_cost[next]) {
+					local_cost[next] = cost + step;
+					local_parent[next] = cur;
+					open.push(Path_Open(cost + step, next));
+				}
+			}
+		}
+	}
+}
+
+int PathFinder::localCost(Point tile) {
+	if (tile.x < local_rect.x || tile.y < local_rect.y || tile.x >= local_rect.x + local_rect.w || tile.y >= local_rect.y + local_rect.h)
+		return PATH_UNREACHABLE;
+	return local_cost[(tile.y - local_rect.y) * local_rect.w + (tile.x - local_rect.x)];
+}
+
+/**
+ * Tile path between two tiles of the same cluster, appended to tiles
+ * The first tile is not included, the last one is.
+ */
+bool PathFinder::localPath(Point from, Point to, vector<Point> &tiles) {
+	searchCluster(from, clusterOf(from.x, from.y));
+	if (localCost(to) == PATH_UNREACHABLE) return false;
+
+	vector<Point> reversed;
+	int cur = (to.y - local_rect.y) * local_rect.w + (to.x - local_rect.x);
+	while (local_parent[cur] != -1) {
+		Point p;
+		p.x = local_rect.x + cur % local_rect.w;
+		p.y = local_rect.y + cur / local_rect.w;
+		reversed.push_back(p);
+		cur = local_parent[cur];
+	}
+	tiles.insert(tiles.end(), reversed.rbegin(), reversed.rend());
+	return true;
+}
+
+/**
+ * Reduce a tile path to the points where it has to turn.
+ * A tile is skipped whenever the straight line past it is walkable.
+ */
+void PathFinder::smooth(Point start, Point goal, vector<Point> &tiles, vector<Point> &waypoints) {
+	vector<Point> points;
+	for (unsigned i=0; i<tiles.size(); i++) {
+		Point p;
+		p.x = tiles[i].x * UNITS_PER_TILE + UNITS_PER_TILE/2;
+		p.y = tiles[i].y * UNITS_PER_TILE + UNITS_PER_TILE/2;
+		points.push_back(p);
+	}
+	if (points.empty()) points.push_back(goal);
+	else points.back() = goal;
+
+	Point anchor = start;
+	unsigned i = 0;
+	while (i < points.size()) {
+		unsigned k = i;
+		while (k+1 < points.size() && collider->line_of_movement(anchor.x, anchor.y, points[k+1].x, points[k+1].y)) {
+			k++;
+		}
+		waypoints.push_back(points[k]);
+		anchor = points[k];
+		i = k+1;
+	}
+}
+
+/**
+ * Find a walkable route between two map positions.
+ * Queries beyond this frame's budget are refused; callers should try again later.
+ *
+ * @param waypoints Receives the smoothed route in map units, ending at goal
+ * @return false if no route was found or the budget is used up
+ */
+bool PathFinder::findPath(Point start, Point goal, vector<Point> &waypoints) {
+	waypoints.clear();
+	if (collider == NULL || queries_left <= 0) return false;
+	queries_left--;
+
+	Point s;
+	Point g;
+	s.x = start.x >> TILE_SHIFT;
+	s.y = start.y >> TILE_SHIFT;
+	g.x = goal.x >> TILE_SHIFT;
+	g.y = goal.y >> TILE_SHIFT;
+	if (!walkable(s.x, s.y) || !walkable(g.x, g.y)) return false;
+
+	if (s.x == g.x && s.y == g.y) {
+		waypoints.push_back(goal);
+		return true;
+	}
+
+	int start_cluster = clusterOf(s.x, s.y);
+	int goal_cluster = clusterOf(g.x, g.y);
+
+	// abstract search over the cluster nodes plus a virtual start and goal
+	int node_count = nodes.size();
+	int START = node_count;
+	int GOAL = node_count + 1;
+	vector<int> cost(node_count + 2, PATH_UNREACHABLE);
+	vector<int> parent(node_count + 2, -1);
+	vector<int> goal_link(node_count, PATH_UNREACHABLE);
+	vector<bool> closed(node_count + 2, false);
+	Path_Queue open;
+
+	// distance from each node of the goal cluster to the goal
+	searchCluster(g, goal_cluster);
+	for (unsigned i=0; i<cluster_nodes[goal_cluster].size(); i++) {
+		int id = cluster_nodes[goal_cluster][i];
+		goal_link[id] = localCost(nodes[id].tile);
+	}
+	if (start_cluster == goal_cluster && localCost(s) != PATH_UNREACHABLE) {
+		cost[GOAL] = localCost(s);
+		parent[GOAL] = START;
+		open.push(Path_Open(cost[GOAL], GOAL));
+	}
+
+	// distance from the start to each node of its cluster
+	searchCluster(s, start_cluster);
+	for (unsigned i=0; i<cluster_nodes[start_cluster].size(); i++) {
+		int id = cluster_nodes[start_cluster][i];
+		int c = localCost(nodes[id].tile);
+		if (c == PATH_UNREACHABLE) continue;
+		cost[id] = c;
+		parent[id] = START;
+		int dx = abs(nodes[id].tile.x - g.x);
+		int dy = abs(nodes[id].tile.y - g.y);
+		open.push(Path_Open(c + PATH_COST_STRAIGHT * max(dx,dy) + (PATH_COST_DIAGONAL - PATH_COST_STRAIGHT) * min(dx,dy), id));
+	}
+
+	while (!open.empty()) {
+		int cur = open.top().second;
+		open.pop();
+		if (cur == GOAL) break;
+		if (closed[cur]) continue;
+		closed[cur] = true;
+
+		if (goal_link[cur] != PATH_UNREACHABLE && cost[cur] + goal_link[cur] < cost[GOAL]) {
+			cost[GOAL] = cost[cur] + goal_link[cur];
+			parent[GOAL] = cur;
+			open.push(Path_Open(cost[GOAL], GOAL));
+		}
+
+		for (unsigned i=0; i<nodes[cur].edges.size(); i++) {
+			Path_Edge &e = nodes[cur].edges[i];
+			if (closed[e.to] || cost[cur] + e.cost >= cost[e.to]) continue;
+			cost[e.to] = cost[cur] + e.cost;
+			parent[e.to] = cur;
+			int dx = abs(nodes[e.to].tile.x - g.x);
+			int dy = abs(nodes[e.to].tile.y - g.y);
+			open.push(Path_Open(cost[e.to] + PATH_COST_STRAIGHT * max(dx,dy) + (PATH_COST_DIAGONAL - PATH_COST_STRAIGHT) * min(dx,dy), e.to));
+		}
+	}
+	if (parent[GOAL] == -1) return false;
+
+	// abstract route, start to goal
+	vector<int> route;
+	for (int id = parent[GOAL]; id != START; id = parent[id]) {
+		route.push_back(id);
+	}
+	reverse(route.begin(), route.end());
+
+	// refine each leg into tiles
+	vector<Point> tiles;
+	Point cur = s;
+	for (unsigned i=0; i<route.size(); i++) {
+		Point next = nodes[route[i]].tile;
+		if (next.x == cur.x && next.y == cur.y) continue;
+		if (clusterOf(cur.x, cur.y) == clusterOf(next.x, next.y)) {
+			if (!localPath(cur, next, tiles)) return false;
+		}
+		else {
+			tiles.push_back(next);
+		}
+		cur = next;
+	}
+	if (!localPath(cur, g, tiles)) return false;
+
+	smooth(start, goal, tiles, waypoints);
+	return true;
+}
+
+PathFinder::~PathFinder() {
+}
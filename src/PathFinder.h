@@ -0,0 +1,105 @@
+/**
+ * class PathFinder
+ *
+ * Hierarchical pathfinding (HPA*) on the collision layer.
+ *
+ * The map is divided into square clusters.  Open runs of tiles along the
+ * border of two clusters become entrances; entrances of the same cluster
+ * are linked by their walking distance inside the cluster.  A query searches
+ * this small abstract graph and only then walks tile by tile, one cluster at
+ * a time.  The resulting tile path is smoothed into a few waypoints.
+ *
+ * When a tile of the collision layer changes, only the surrounding clusters
+ * are rebuilt.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef PATH_FINDER_H
+#define PATH_FINDER_H
+
+#include <vector>
+#include "Utils.h"
+#include "MapCollision.h"
+
+using namespace std;
+
+// width and height of a cluster, in tiles
+const int PATH_CLUSTER_SIZE = 16;
+
+// how many path queries may run each frame
+const int PATH_QUERIES_PER_FRAME = 4;
+
+// move costs
+const int PATH_COST_STRAIGHT = 10;
+const int PATH_COST_DIAGONAL = 14;
+
+struct Path_Edge {
+	int to;
+	int cost;
+	bool inter; // crosses into the neighbouring cluster
+};
+
+struct Path_Node {
+	Point tile;
+	int cluster;
+	int refs; // entrances using this node
+	vector<Path_Edge> edges;
+};
+
+struct Path_Entrance {
+	int a; // node on the near side of the border
+	int b; // node on the far side
+};
+
+class PathFinder {
+private:
+	MapCollision *collider;
+	Point map_size;
+	Point clusters; // cluster grid size
+
+	vector<Path_Node> nodes;
+	vector<int> free_nodes;
+	vector<int> tile_node; // node id of each tile, or -1
+	vector< vector<int> > cluster_nodes;
+	vector< vector<Path_Entrance> > east_entrances; // per cluster, border with the cluster to the east
+	vector< vector<Path_Entrance> > south_entrances; // per cluster, border with the cluster to the south
+
+	int queries_left;
+
+	// scratch space for searches inside one cluster
+	int local_cost[PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE];
+	int local_parent[PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE];
+	SDL_Rect local_rect;
+
+	bool walkable(int x, int y);
+	int clusterOf(int x, int y);
+	SDL_Rect clusterRect(int cluster);
+
+	int addNode(Point tile);
+	void releaseNode(int id);
+	void removeEdge(int from, int to);
+	void buildEntrances(int cluster, bool east);
+	void clearEntrances(int cluster, bool east);
+	void buildEdges(int cluster);
+	void rebuild(int cluster);
+
+	void searchCluster(Point from, int cluster);
+	int localCost(Point tile);
+	bool localPath(Point from, Point to, vector<Point> &tiles);
+
+	void smooth(Point start, Point goal, vector<Point> &tiles, vector<Point> &waypoints);
+
+public:
+	PathFinder();
+	~PathFinder();
+
+	void init(MapCollision *_collider);
+	void tileChanged(int x, int y);
+	void beginFrame();
+
+	bool findPath(Point start, Point goal, vector<Point> &waypoints);
+};
+
+#endif
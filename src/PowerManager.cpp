@@ -17,6 +17,7 @@ PowerManager::PowerManager() {
 	sfx_count = 0;
 	for (int i=0; i<POWER_MAX_GFX; i++) {
 		gfx[i] = NULL;
+		gfx_atlas[i] = NULL;
 	}
 	for (int i=0; i<POWER_MAX_SFX; i++) {
 		sfx[i] = NULL;
@@ -34,6 +35,7 @@ PowerManager::PowerManager() {
 	
 	loadGraphics();
 	loadPowers();
+	loadAtlases();
 }
 
 /**
@@ -319,6 +321,51 @@ void PowerManager::loadPowers() {
 	infile.close();
 }
 
+/**
+ * Pack the power graphics that are only ever drawn as hazards.
+ * The frame size comes from the powers using the sheet; sheets that are
+ * also used for other effects, or with conflicting frame sizes, stay as-is.
+ */
+void PowerManager::loadAtlases() {
+	for (int i=0; i<gfx_count; i++) {
+		if (gfx[i] == NULL) continue;
+
+		bool packable = true;
+		bool used = false;
+		Point frame_size;
+		frame_size.x = frame_size.y = 0;
+
+		for (int j=0; j<POWER_COUNT && packable; j++) {
+			if (powers[j].gfx_index != i) continue;
+			if (!powers[j].rendered) {
+				packable = false;
+				break;
+			}
+
+			// hazards default to 64x64 frames
+			Point size = powers[j].frame_size;
+			if (size.x == 0) size.x = 64;
+			if (size.y == 0) size.y = 64;
+
+			if (used && (size.x != frame_size.x || size.y != frame_size.y))
+				packable = false;
+			frame_size = size;
+			used = true;
+		}
+		if (!used || !packable) continue;
+
+		gfx_atlas[i] = new SpriteAtlas();
+		if (gfx_atlas[i]->build(gfx[i], frame_size)) {
+			SDL_FreeSurface(gfx[i]);
+			gfx[i] = NULL;
+		}
+		else {
+			delete gfx_atlas[i];
+			gfx_atlas[i] = NULL;
+		}
+	}
+}
+
 /**
  * Load the specified graphic for this power
  *
@@ -345,9 +392,7 @@ int PowerManager::loadGFX(string filename) {
 	}
 	
 	// optimize
-	SDL_Surface *cleanup = gfx[gfx_count];
-	gfx[gfx_count] = SDL_DisplayFormatAlpha(gfx[gfx_count]);
-	SDL_FreeSurface(cleanup);	
+	gfx[gfx_count] = optimizeSurface(gfx[gfx_count]);
 
 	// success; perform record-keeping
 	gfx_filenames[gfx_count] = filename;
@@ -484,6 +529,7 @@ void PowerManager::initHazard(int power_index, StatBlock *src_stats, Point targe
 	
 	if (powers[power_index].gfx_index != -1) {
 		haz->sprites = gfx[powers[power_index].gfx_index];
+		haz->atlas = gfx_atlas[powers[power_index].gfx_index];
 	}
 	if (powers[power_index].rendered) {
 		haz->rendered = powers[power_index].rendered;
@@ -707,7 +753,7 @@ void PowerManager::playSound(int power_index, StatBlock *src_stats) {
 bool PowerManager::effect(int power_index, StatBlock *src_stats, Point target) {
 
 	if (powers[power_index].use_hazard) {
-		Hazard *haz = new Hazard();
+		Hazard *haz = hazard_pool.alloc();
 		initHazard(power_index, src_stats, target, haz);
 		
 		// Hazard memory is now the responsibility of HazardManager
@@ -751,7 +797,7 @@ bool PowerManager::missile(int power_index, StatBlock *src_stats, Point target)
 
 	//generate hazards
 	for (int i=0; i < powers[power_index].missile_num; i++) {
-		haz[i] = new Hazard();
+		haz[i] = hazard_pool.alloc();
 		Point rot_target;
 
 		//calculate individual missile angle
@@ -828,7 +874,7 @@ bool PowerManager::repeater(int power_index, StatBlock *src_stats, Point target)
 			break; // no more hazards
 		}
 		
-		haz[i] = new Hazard();
+		haz[i] = hazard_pool.alloc();
 		initHazard(power_index, src_stats, target, haz[i]);
 
 		haz[i]->pos.x = location_iterator.x;
@@ -851,7 +897,7 @@ bool PowerManager::repeater(int power_index, StatBlock *src_stats, Point target)
  */
 bool PowerManager::single(int power_index, StatBlock *src_stats, Point target) {
 	
-	Hazard *haz = new Hazard();
+	Hazard *haz = hazard_pool.alloc();
 	
 	// common to all singles
 	haz->pos.x = (float)target.x;
@@ -906,6 +952,7 @@ PowerManager::~PowerManager() {
 	for (int i=0; i<gfx_count; i++) {
 		if (gfx[i] != NULL)
 			SDL_FreeSurface(gfx[i]);
+		delete gfx_atlas[i];
 	}
 	for (int i=0; i<sfx_count; i++) {
 		if (sfx[i] != NULL)
@@ -15,6 +15,7 @@
 #include "Utils.h"
 #include "StatBlock.h"
 #include "Hazard.h"
+#include "HazardPool.h"
 #include "MapCollision.h"
 
 #ifndef POWER_MANAGER_H
@@ -239,6 +240,7 @@ private:
 
 	void loadPowers();
 	void loadGraphics();
+	void loadAtlases();
 	
 	int loadGFX(string filename);
 	int loadSFX(string filename);
@@ -267,9 +269,11 @@ public:
 		
 	Power powers[POWER_COUNT];
 	queue<Hazard *> hazards; // output; read by HazardManager
+	HazardPool hazard_pool; // every hazard comes from here and is released by HazardManager
 
 	// shared images/sounds for power special effects
 	SDL_Surface *gfx[POWER_MAX_GFX];
+	SpriteAtlas *gfx_atlas[POWER_MAX_GFX]; // replaces gfx[] for hazard-only sheets
 	Mix_Chunk *sfx[POWER_MAX_SFX];
 	
 	SDL_Surface *freeze;
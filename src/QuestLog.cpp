@@ -14,7 +14,9 @@ QuestLog::QuestLog(CampaignManager *_camp, MenuLog *_log) {
 	log = _log;
 	
 	quest_count = 0;
+	found_text = -1;
 	loadAll();
+	shown.resize(quest_count, -1);
 }
 
 /**
@@ -52,7 +54,6 @@ void QuestLog::load(string filename) {
 	string val;
 	string starts_with;
 	string section = "";
-	int event_count = 0;
 	
 	infile.open(("quests/" + filename).c_str(), ios::in);
 
@@ -69,8 +70,8 @@ void QuestLog::load(string filename) {
 				else if (starts_with == "[") {
 					section = parse_section_title(line);
 					if (section == "quest") {
+						quests.beginProgram();
 						quest_count++;
-						event_count = 0;
 					}
 				}
 				else { // this is data.  treatment depends on key
@@ -78,13 +79,16 @@ void QuestLog::load(string filename) {
 					key = trim(key, ' ');
 					val = trim(val, ' ');
 					
-					quests[quest_count-1][event_count].type = key;
-					quests[quest_count-1][event_count].s = val;
-					event_count++;
-					
 					// requires_status=s
 					// requires_not=s
 					// quest_text=s			
+					Event_Component ec;
+					ec.type = atom(key);
+					ec.s = val;
+					if (ec.type == ATOM_REQUIRES_STATUS || ec.type == ATOM_REQUIRES_NOT)
+						watch(atom(val), quest_count-1);
+					if (ec.type == ATOM_REQUIRES_STATUS || ec.type == ATOM_REQUIRES_NOT || ec.type == ATOM_QUEST_TEXT)
+						quests.add(ec);
 				}
 			}
 		}
@@ -92,11 +96,32 @@ void QuestLog::load(string filename) {
 	infile.close();	
 }
 
+void QuestLog::watch(int status, int quest) {
+	if (status == ATOM_NONE || quest < 0) return;
+	if (status >= (int)watchers.size()) watchers.resize(status+1);
+	
+	vector<int> &list = watchers[status];
+	if (list.empty() || list.back() != quest) list.push_back(quest);
+}
+
 void QuestLog::logic() {
 	if (camp->quest_update) {
 		camp->quest_update = false;
+		camp->status_changed.clear();
 		createQuestList();
+		return;
 	}
+	
+	// re-check only the quests that depend on a changed status
+	for (unsigned i=0; i<camp->status_changed.size(); i++) {
+		int status = camp->status_changed[i];
+		if (status >= (int)watchers.size()) continue;
+		
+		for (unsigned j=0; j<watchers[status].size(); j++) {
+			updateQuest(watchers[status][j]);
+		}
+	}
+	camp->status_changed.clear();
 }
 
 /**
@@ -105,27 +130,55 @@ void QuestLog::logic() {
 void QuestLog::createQuestList() {
 	log->clear(LOG_TYPE_QUESTS);
 	
+	// insert rather than add: the quest tab isn't capped like the message tab
+	int index = 0;
 	for (int i=0; i<quest_count; i++) {
-		for (int j=0; j<MAX_QUEST_EVENTS; j++) {
-			
-			// check requirements
-			// break (skip to next dialog node) if any requirement fails
-			// if we reach an event that is not a requirement, succeed
-			
-			if (quests[i][j].type == "requires_status") {
-				if (!camp->checkStatus(quests[i][j].s)) break;
-			}
-			else if (quests[i][j].type == "requires_not") {
-				if (camp->checkStatus(quests[i][j].s)) break;
-			}
-			else if (quests[i][j].type == "quest_text") {
-				log->add(quests[i][j].s, LOG_TYPE_QUESTS);
-				break;
-			}
-			else if (quests[i][j].type == "") {
-				break;
-			}
-		}
+		shown[i] = evaluate(i);
+		if (shown[i] != -1)
+			log->insert(index++, quests.getString(shown[i]), LOG_TYPE_QUESTS);
+	}
+	
+}
+
+/**
+ * Each quest stops at its first unmet requirement or at its text
+ *
+ * @return the string index of the quest's text, or -1 if it isn't shown
+ */
+int QuestLog::evaluate(int quest) {
+	found_text = -1;
+	if (quests.run(quests.entry(quest), SCRIPT_RUN, camp, this) == SCRIPT_FAILED)
+		return -1;
+	return found_text;
+}
+
+/**
+ * Patch this quest's entry in the Quest tab.
+ * Entries are kept in quest order, one for each quest being shown.
+ */
+void QuestLog::updateQuest(int quest) {
+	int text = evaluate(quest);
+	if (text == shown[quest]) return;
+
+	int index = 0;
+	for (int i=0; i<quest; i++) {
+		if (shown[i] != -1) index++;
 	}
 	
+	if (shown[quest] == -1)
+		log->insert(index, quests.getString(text), LOG_TYPE_QUESTS);
+	else if (text == -1)
+		log->remove(index, LOG_TYPE_QUESTS);
+	else
+		log->replace(index, quests.getString(text), LOG_TYPE_QUESTS);
+	
+	shown[quest] = text;
+}
+
+bool QuestLog::eventOp(const Event_Op &op, EventScript *) {
+	if (op.op == OP_QUEST_TEXT) {
+		found_text = op.s;
+		return true;
+	}
+	return false;
 }
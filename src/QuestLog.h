@@ -12,27 +12,37 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 #include "Utils.h"
 #include "CampaignManager.h"
 #include "MenuLog.h"
+#include "EventScript.h"
 
-const int MAX_QUESTS = 1024;
-const int MAX_QUEST_EVENTS = 4;
-
-class QuestLog {
+class QuestLog : public EventHandler {
 private:
 	CampaignManager *camp;
 	MenuLog *log;
 	
-	Event_Component quests[MAX_QUESTS][MAX_QUEST_EVENTS];
+	EventScript quests; // one program per quest
 	int quest_count;
 	
+	// quest ids whose requirements mention each status atom
+	vector< vector<int> > watchers;
+	void watch(int status, int quest);
+	
+	// string index of the text each quest shows in the log, or -1
+	vector<int> shown;
+	int found_text;
+	int evaluate(int quest);
+	void updateQuest(int quest);
+	
 public:
 	QuestLog(CampaignManager *_camp, MenuLog *_log);
 	void loadAll();
 	void load(string filename);
 	void logic();
 	void createQuestList();
+	bool eventOp(const Event_Op &op, EventScript *script);
 };
 
 #endif
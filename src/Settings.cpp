@@ -31,12 +31,16 @@ int VIEW_W_HALF = VIEW_W/2;
 int VIEW_H_HALF = VIEW_H/2;
 bool DOUBLEBUF = false;
 bool HWSURFACE = false;
+bool PALETTED_SPRITES = false;
 
 // Audio Settings
 int MUSIC_VOLUME = 64;
 int SOUND_VOLUME = 64;
 bool MENUS_PAUSE = false;
 
+// Engine Settings
+int AI_THREADS = 1;
+
 // Input Settings
 bool MOUSE_MOVE = false;
 
@@ -97,6 +101,12 @@ bool loadSettings() {
 					else if (key == "doublebuf") {
 						if (val == "1") DOUBLEBUF = true;
 					}
+					else if (key == "paletted_sprites") {
+						if (val == "1") PALETTED_SPRITES = true;
+					}
+					else if (key == "ai_threads") {
+						AI_THREADS = atoi(val.c_str());
+					}
 				}
 			}
 		}
@@ -19,12 +19,14 @@ extern int VIEW_W_HALF;
 extern int VIEW_H_HALF;
 extern bool DOUBLEBUF;
 extern bool HWSURFACE;
+extern bool PALETTED_SPRITES;
 
 // Input Settings
 extern bool MOUSE_MOVE;
 
 // Engine Settings
 extern bool MENUS_PAUSE;
+extern int AI_THREADS;
 
 // Tile Settings
 extern int UNITS_PER_TILE;
@@ -0,0 +1,129 @@
+/**
+ * class SpatialHash
+ *
+ * Uniform grid of ids bucketed by map position.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "SpatialHash.h"
+#include <algorithm>
+
+SpatialHash::SpatialHash() {
+	cells.x = cells.y = 0;
+}
+
+/**
+ * Size the grid for a map
+ *
+ * @param map_w Map width in tiles
+ * @param map_h Map height in tiles
+ */
+void SpatialHash::init(int map_w, int map_h) {
+	int cell_size = 1 << SPATIAL_CELL_SHIFT;
+	cells.x = max(1, (map_w * UNITS_PER_TILE + cell_size - 1) / cell_size);
+	cells.y = max(1, (map_h * UNITS_PER_TILE + cell_size - 1) / cell_size);
+	grid.assign(cells.x * cells.y, vector<int>());
+}
+
+void SpatialHash::clear() {
+	for (unsigned i=0; i<grid.size(); i++) {
+		grid[i].clear();
+	}
+}
+
+// positions off the map are filed in the nearest border cell
+int SpatialHash::cellX(int x) {
+	return max(0, min(cells.x - 1, x >> SPATIAL_CELL_SHIFT));
+}
+
+int SpatialHash::cellY(int y) {
+	return max(0, min(cells.y - 1, y >> SPATIAL_CELL_SHIFT));
+}
+
+void SpatialHash::insert(int id, Point pos) {
+	if (grid.empty()) return;
+	grid[cellY(pos.y) * cells.x + cellX(pos.x)].push_back(id);
+}
+
+void SpatialHash::remove(int id, Point pos) {
+	if (grid.empty()) return;
+	vector<int> &cell = grid[cellY(pos.y) * cells.x + cellX(pos.x)];
+	vector<int>::iterator it = find(cell.begin(), cell.end(), id);
+	if (it != cell.end()) {
+		*it = cell.back();
+		cell.pop_back();
+	}
+}
+
+/**
+ * Refile an id after it moved.  Nothing is done while it stays in the same cell.
+ */
+void SpatialHash::move(int id, Point from, Point to) {
+	if (cellX(from.x) == cellX(to.x) && cellY(from.y) == cellY(to.y)) return;
+	remove(id, from);
+	insert(id, to);
+}
+
+/**
+ * Gather the ids of every cell in the inclusive map-unit box, sorted
+ */
+void SpatialHash::collect(int x1, int y1, int x2, int y2, vector<int> &found) {
+	found.clear();
+	if (grid.empty()) return;
+
+	int cx1 = cellX(x1);
+	int cy1 = cellY(y1);
+	int cx2 = cellX(x2);
+	int cy2 = cellY(y2);
+	for (int cy=cy1; cy<=cy2; cy++) {
+		for (int cx=cx1; cx<=cx2; cx++) {
+			vector<int> &cell = grid[cy * cells.x + cx];
+			found.insert(found.end(), cell.begin(), cell.end());
+		}
+	}
+	sort(found.begin(), found.end());
+}
+
+/**
+ * Candidates that may lie within radius of center
+ */
+void SpatialHash::query(Point center, int radius, vector<int> &found) {
+	collect(center.x - radius, center.y - radius, center.x + radius, center.y + radius, found);
+}
+
+/**
+ * Candidates that may lie inside a rectangle of map units
+ */
+void SpatialHash::query(SDL_Rect area, vector<int> &found) {
+	collect(area.x, area.y, area.x + area.w, area.y + area.h, found);
+}
+
+/**
+ * Candidates whose map position may appear inside a rectangle of the screen
+ */
+void SpatialHash::queryScreen(SDL_Rect screen_area, Point cam, vector<int> &found) {
+	Point corner[4];
+	corner[0] = screen_to_map(screen_area.x, screen_area.y, cam.x, cam.y);
+	corner[1] = screen_to_map(screen_area.x + screen_area.w, screen_area.y, cam.x, cam.y);
+	corner[2] = screen_to_map(screen_area.x, screen_area.y + screen_area.h, cam.x, cam.y);
+	corner[3] = screen_to_map(screen_area.x + screen_area.w, screen_area.y + screen_area.h, cam.x, cam.y);
+
+	int x1 = corner[0].x;
+	int y1 = corner[0].y;
+	int x2 = corner[0].x;
+	int y2 = corner[0].y;
+	for (int i=1; i<4; i++) {
+		x1 = min(x1, corner[i].x);
+		y1 = min(y1, corner[i].y);
+		x2 = max(x2, corner[i].x);
+		y2 = max(y2, corner[i].y);
+	}
+
+	// map_to_screen rounds to whole pixels; leave a tile of slack
+	collect(x1 - UNITS_PER_TILE, y1 - UNITS_PER_TILE, x2 + UNITS_PER_TILE, y2 + UNITS_PER_TILE, found);
+}
+
+SpatialHash::~SpatialHash() {
+}
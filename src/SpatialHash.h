@@ -0,0 +1,51 @@
+/**
+ * class SpatialHash
+ *
+ * Uniform grid of ids bucketed by map position.
+ *
+ * Each id is filed in the cell under its position.  Radius and rectangle
+ * queries only visit the cells they overlap and return candidate ids in
+ * ascending order, so callers can keep the order of a plain linear scan and
+ * do their exact test on the candidates only.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <vector>
+#include "SDL.h"
+#include "Utils.h"
+
+using namespace std;
+
+// cells are 256 map units (4 tiles) wide
+const int SPATIAL_CELL_SHIFT = 8;
+
+class SpatialHash {
+private:
+	Point cells; // grid size
+	vector< vector<int> > grid;
+
+	int cellX(int x);
+	int cellY(int y);
+	void collect(int x1, int y1, int x2, int y2, vector<int> &found);
+
+public:
+	SpatialHash();
+	~SpatialHash();
+
+	void init(int map_w, int map_h);
+	void clear();
+	void insert(int id, Point pos);
+	void remove(int id, Point pos);
+	void move(int id, Point from, Point to);
+
+	void query(Point center, int radius, vector<int> &found);
+	void query(SDL_Rect area, vector<int> &found);
+	void queryScreen(SDL_Rect screen_area, Point cam, vector<int> &found);
+};
+
+#endif
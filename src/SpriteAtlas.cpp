@@ -0,0 +1,204 @@
+/**
+ * class SpriteAtlas
+ *
+ * Repacks a fixed-grid sprite sheet into a compact atlas.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "SpriteAtlas.h"
+#include <algorithm>
+
+/**
+ * Orders frame indices tallest first, which keeps the packing shelves tight
+ */
+struct AtlasFrameHeight {
+	vector<AtlasFrame> *frames;
+	bool operator()(int a, int b) const {
+		if ((*frames)[a].src.h != (*frames)[b].src.h)
+			return (*frames)[a].src.h > (*frames)[b].src.h;
+		return a < b;
+	}
+};
+
+SpriteAtlas::SpriteAtlas() {
+	sheet = NULL;
+	frame_size.x = frame_size.y = 0;
+	columns = rows = 0;
+}
+
+/**
+ * A pixel is visible unless it matches the colorkey or has zero alpha
+ */
+bool SpriteAtlas::isVisible(SDL_Surface *surface, int x, int y) {
+	Uint32 pixel = readPixel(surface, x, y);
+	if ((surface->flags & SDL_SRCCOLORKEY) && pixel == surface->format->colorkey)
+		return false;
+	if (surface->format->Amask && (pixel & surface->format->Amask) == 0)
+		return false;
+	return true;
+}
+
+/**
+ * Find the bounding box of the visible pixels of one grid cell
+ * A fully transparent cell becomes an empty frame
+ */
+void SpriteAtlas::trimCell(SDL_Surface *surface, int col, int row, AtlasFrame &frame) {
+	int left = frame_size.x;
+	int top = frame_size.y;
+	int right = -1;
+	int bottom = -1;
+	int cell_x = col * frame_size.x;
+	int cell_y = row * frame_size.y;
+
+	for (int y=0; y<frame_size.y; y++) {
+		for (int x=0; x<frame_size.x; x++) {
+			if (isVisible(surface, cell_x + x, cell_y + y)) {
+				if (x < left) left = x;
+				if (x > right) right = x;
+				if (y < top) top = y;
+				if (y > bottom) bottom = y;
+			}
+		}
+	}
+
+	frame.src.x = frame.src.y = 0;
+	if (right < 0) {
+		frame.src.w = frame.src.h = 0;
+		frame.trim.x = frame.trim.y = 0;
+		return;
+	}
+	frame.trim.x = left;
+	frame.trim.y = top;
+	frame.src.w = right - left + 1;
+	frame.src.h = bottom - top + 1;
+}
+
+/**
+ * Build the atlas from a sheet laid out in cells of _frame_size.
+ * The source surface is left untouched; the caller may free it afterwards.
+ *
+ * @return false if the source cannot be packed
+ */
+bool SpriteAtlas::build(SDL_Surface *source, Point _frame_size) {
+	clear();
+	if (source == NULL || _frame_size.x <= 0 || _frame_size.y <= 0) return false;
+
+	frame_size = _frame_size;
+	columns = source->w / frame_size.x;
+	rows = source->h / frame_size.y;
+	if (columns == 0 || rows == 0) return false;
+
+	frames.resize(columns * rows);
+
+	// trim every cell
+	if (SDL_MUSTLOCK(source)) SDL_LockSurface(source);
+	for (int row=0; row<rows; row++) {
+		for (int col=0; col<columns; col++) {
+			trimCell(source, col, row, frames[row * columns + col]);
+		}
+	}
+	if (SDL_MUSTLOCK(source)) SDL_UnlockSurface(source);
+
+	// shelf-pack the trimmed frames, tallest first
+	int sheet_w = min(source->w, ATLAS_MAX_WIDTH);
+	vector<int> order;
+	for (unsigned i=0; i<frames.size(); i++) {
+		if (frames[i].src.w > 0) order.push_back(i);
+		if (frames[i].src.w > sheet_w) sheet_w = frames[i].src.w;
+	}
+	AtlasFrameHeight tallest;
+	tallest.frames = &frames;
+	sort(order.begin(), order.end(), tallest);
+
+	int shelf_x = 0;
+	int shelf_y = 0;
+	int shelf_h = 0;
+	for (unsigned i=0; i<order.size(); i++) {
+		AtlasFrame &f = frames[order[i]];
+		if (shelf_x + f.src.w > sheet_w) {
+			shelf_y += shelf_h;
+			shelf_x = 0;
+			shelf_h = 0;
+		}
+		f.src.x = shelf_x;
+		f.src.y = shelf_y;
+		shelf_x += f.src.w;
+		if (f.src.h > shelf_h) shelf_h = f.src.h;
+	}
+	int sheet_h = shelf_y + shelf_h;
+	if (sheet_h == 0) sheet_h = 1;
+
+	SDL_PixelFormat *fmt = source->format;
+	sheet = SDL_CreateRGBSurface(SDL_SWSURFACE, sheet_w, sheet_h, fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	if (!sheet) {
+		fprintf(stderr, "Couldn't create sprite atlas: %s\n", SDL_GetError());
+		frames.clear();
+		return false;
+	}
+	if (fmt->palette) SDL_SetColors(sheet, fmt->palette->colors, 0, fmt->palette->ncolors);
+
+	// copy raw pixels: switch off keying and blending on the source while packing
+	Uint32 key_flags = source->flags & (SDL_SRCCOLORKEY | SDL_RLEACCEL);
+	Uint32 colorkey = fmt->colorkey;
+	Uint32 alpha_flags = source->flags & SDL_SRCALPHA;
+	Uint8 alpha = fmt->alpha;
+	SDL_SetColorKey(source, 0, 0);
+	SDL_SetAlpha(source, 0, 255);
+
+	SDL_FillRect(sheet, NULL, (key_flags & SDL_SRCCOLORKEY) ? colorkey : 0);
+
+	SDL_Rect src;
+	SDL_Rect dest;
+	for (int row=0; row<rows; row++) {
+		for (int col=0; col<columns; col++) {
+			AtlasFrame &f = frames[row * columns + col];
+			if (f.src.w == 0) continue;
+			src.x = col * frame_size.x + f.trim.x;
+			src.y = row * frame_size.y + f.trim.y;
+			src.w = dest.w = f.src.w;
+			src.h = dest.h = f.src.h;
+			dest.x = f.src.x;
+			dest.y = f.src.y;
+			SDL_BlitSurface(source, &src, sheet, &dest);
+		}
+	}
+
+	// restore the source and give the atlas the same blending behaviour
+	SDL_SetColorKey(source, key_flags, colorkey);
+	SDL_SetAlpha(source, alpha_flags, alpha);
+	SDL_SetColorKey(sheet, key_flags, colorkey);
+	SDL_SetAlpha(sheet, alpha_flags, alpha);
+
+	return true;
+}
+
+/**
+ * Translate the grid rectangle of a renderable into its packed rectangle.
+ * The offset is shifted by the trimmed margin so the frame lands on the same pixels.
+ */
+void SpriteAtlas::apply(Renderable &r) {
+	if (sheet == NULL) return;
+
+	int col = r.src.x / frame_size.x;
+	int row = r.src.y / frame_size.y;
+	if (col < 0 || col >= columns || row < 0 || row >= rows) return;
+
+	AtlasFrame &f = frames[row * columns + col];
+	r.sprite = sheet;
+	r.src = f.src;
+	r.offset.x -= f.trim.x;
+	r.offset.y -= f.trim.y;
+}
+
+void SpriteAtlas::clear() {
+	if (sheet) SDL_FreeSurface(sheet);
+	sheet = NULL;
+	frames.clear();
+	columns = rows = 0;
+}
+
+SpriteAtlas::~SpriteAtlas() {
+	clear();
+}
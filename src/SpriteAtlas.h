@@ -0,0 +1,58 @@
+/**
+ * class SpriteAtlas
+ *
+ * Repacks a fixed-grid sprite sheet into a compact atlas.
+ * Each grid cell is trimmed to the bounds of its visible pixels and the trimmed
+ * frames are shelf-packed into a new, smaller surface.  Transparent padding is
+ * no longer stored nor blitted.
+ *
+ * Rendering code keeps computing the logical grid rectangle of a frame and asks
+ * the atlas to translate it into the packed rectangle and adjusted offset.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include "SDL.h"
+#include "Utils.h"
+#include <vector>
+
+// widest atlas sheet we will create
+const int ATLAS_MAX_WIDTH = 2048;
+
+struct AtlasFrame {
+	SDL_Rect src; // packed location of the trimmed frame
+	Point trim;   // top-left of the trimmed frame inside its original grid cell
+};
+
+class SpriteAtlas {
+private:
+	SDL_Surface *sheet;
+	vector<AtlasFrame> frames;
+	Point frame_size;
+	int columns;
+	int rows;
+
+	bool isVisible(SDL_Surface *surface, int x, int y);
+	void trimCell(SDL_Surface *surface, int col, int row, AtlasFrame &frame);
+
+	// an atlas owns its sheet; prevent accidental shallow copies
+	SpriteAtlas(const SpriteAtlas&);
+	SpriteAtlas& operator=(const SpriteAtlas&);
+
+public:
+	SpriteAtlas();
+	~SpriteAtlas();
+
+	bool build(SDL_Surface *source, Point _frame_size);
+	void clear();
+	void apply(Renderable &r);
+
+	SDL_Surface *getSheet() { return sheet; }
+	Point getFrameSize() { return frame_size; }
+};
+
+#endif
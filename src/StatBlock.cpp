@@ -104,9 +104,9 @@ StatBlock::StatBlock() {
 	death_penalty = false;
 	
 	// campaign status interaction
-	defeat_status = "";
-	quest_loot_requires = "";
-	quest_loot_not = "";
+	defeat_status = ATOM_NONE;
+	quest_loot_requires = ATOM_NONE;
+	quest_loot_not = ATOM_NONE;
 	quest_loot_id = 0;
 	first_defeat_loot = 0;
 	
@@ -165,11 +165,11 @@ void StatBlock::load(string filename) {
 					// enemy death rewards and events
 					else if (key == "xp") xp = num;
 					else if (key == "loot_chance") loot_chance = num;
-					else if (key == "defeat_status") defeat_status = val;
+					else if (key == "defeat_status") defeat_status = atom(val);
 					else if (key == "first_defeat_loot") first_defeat_loot = num;
 					else if (key == "quest_loot") {
-						quest_loot_requires = eatFirstString(val, ',');
-						quest_loot_not = eatFirstString(val, ',');
+						quest_loot_requires = atom(eatFirstString(val, ','));
+						quest_loot_not = atom(eatFirstString(val, ','));
 						quest_loot_id = atoi(val.c_str());
 					}
 					
@@ -239,18 +239,26 @@ void StatBlock::load(string filename) {
  * Reduce temphp first, then hp
  */
 void StatBlock::takeDamage(int dmg) {
+	takeDamage(dmg, hp);
+}
+
+/**
+ * takeDamage() for a creature whose hp is kept outside its StatBlock
+ * (enemies; see Enemy_Columns)
+ */
+void StatBlock::takeDamage(int dmg, int &cur_hp) {
 	if (shield_hp > 0) {
 		shield_hp -= dmg;
 		if (shield_hp < 0) {
-			hp += shield_hp;
+			cur_hp += shield_hp;
 			shield_hp = 0;
 		}
 	}
 	else {
-		hp -= dmg;
+		cur_hp -= dmg;
 	}
-	if (hp <= 0) {
-		hp = 0;
+	if (cur_hp <= 0) {
+		cur_hp = 0;
 		alive = false;
 	}
 }
@@ -312,25 +320,32 @@ void StatBlock::recalc() {
  * Process per-frame actions
  */
 void StatBlock::logic() {
+	logic(hp, cooldown_ticks);
+}
+
+/**
+ * logic() for a creature whose hp and cooldown are kept outside its StatBlock
+ */
+void StatBlock::logic(int &cur_hp, int &cur_cooldown) {
 
 	// handle cooldowns
-	if (cooldown_ticks > 0) cooldown_ticks--; // global cooldown
+	if (cur_cooldown > 0) cur_cooldown--; // global cooldown
 
 	for (int i=0; i<POWERSLOT_COUNT; i++) { // NPC/enemy powerslot cooldown
 		if (power_ticks[i] > 0) power_ticks[i]--;
 	}
 
 	// HP regen
-	if (hp_per_minute > 0 && hp < maxhp && hp > 0) {
+	if (hp_per_minute > 0 && cur_hp < maxhp && cur_hp > 0) {
 		hp_ticker++;
 		if (hp_ticker >= (60 * FRAMES_PER_SEC)/hp_per_minute) {
-			hp++;
+			cur_hp++;
 			hp_ticker = 0;
 		}
 	}
 
 	// MP regen
-	if (mp_per_minute > 0 && mp < maxmp && hp > 0) {
+	if (mp_per_minute > 0 && mp < maxmp && cur_hp > 0) {
 		mp_ticker++;
 		if (mp_ticker >= (60 * FRAMES_PER_SEC)/mp_per_minute) {
 			mp++;
@@ -356,13 +371,13 @@ void StatBlock::logic() {
 	
 	// apply bleed
 	if (bleed_duration % FRAMES_PER_SEC == 1) {
-		takeDamage(1);
+		takeDamage(1, cur_hp);
 	}
 	
 	// apply healing over time
 	if (hot_duration % FRAMES_PER_SEC == 1) {
-		hp += hot_value;
-		if (hp > maxhp) hp = maxhp;
+		cur_hp += hot_value;
+		if (cur_hp > maxhp) cur_hp = maxhp;
 	}
 	
 	// handle targeted
@@ -379,6 +394,86 @@ void StatBlock::logic() {
 
 }
 
+/**
+ * How many of the values from..to (inclusive, from <= to) give a remainder
+ * of 1 when divided by FRAMES_PER_SEC; that is when bleed and heal-over-time tick
+ */
+static int countSecondTicks(int from, int to) {
+	if (to < 1) return 0;
+	int upto_to = (to - 1) / FRAMES_PER_SEC + 1;
+	int upto_from = (from < 2) ? 0 : (from - 2) / FRAMES_PER_SEC + 1;
+	return upto_to - upto_from;
+}
+
+/**
+ * Advance all timers by several frames at once, for creatures that
+ * were not simulated.  Same as calling logic() that many times, except
+ * that bleeding, healing and regeneration are applied in bulk rather than
+ * interleaved frame by frame.
+ */
+void StatBlock::skipTicks(int ticks) {
+	skipTicks(ticks, hp, cooldown_ticks);
+}
+
+void StatBlock::skipTicks(int ticks, int &cur_hp, int &cur_cooldown) {
+	if (ticks <= 0) return;
+
+	// handle cooldowns
+	cur_cooldown = max(0, cur_cooldown - ticks);
+	for (int i=0; i<POWERSLOT_COUNT; i++) {
+		power_ticks[i] = max(0, power_ticks[i] - ticks);
+	}
+
+	// bleed and heal-over-time fire whenever the remaining duration hits 1 mod FRAMES_PER_SEC
+	int bleeds = countSecondTicks(max(0, bleed_duration - ticks), bleed_duration - 1);
+	int heals = countSecondTicks(max(0, hot_duration - ticks), hot_duration - 1);
+
+	// handle buff/debuff durations
+	slow_duration = max(0, slow_duration - ticks);
+	bleed_duration = max(0, bleed_duration - ticks);
+	stun_duration = max(0, stun_duration - ticks);
+	immobilize_duration = max(0, immobilize_duration - ticks);
+	immunity_duration = max(0, immunity_duration - ticks);
+	haste_duration = max(0, haste_duration - ticks);
+	hot_duration = max(0, hot_duration - ticks);
+	targeted = max(0, targeted - ticks);
+
+	for (int i=0; i<bleeds; i++) {
+		takeDamage(1, cur_hp);
+	}
+	if (heals > 0 && cur_hp > 0) {
+		cur_hp = min(maxhp, cur_hp + heals * hot_value);
+	}
+
+	// HP regen
+	if (hp_per_minute > 0 && cur_hp < maxhp && cur_hp > 0) {
+		int period = max(1, (60 * FRAMES_PER_SEC)/hp_per_minute);
+		hp_ticker += ticks;
+		cur_hp += hp_ticker / period;
+		hp_ticker %= period;
+		if (cur_hp >= maxhp) {
+			cur_hp = maxhp;
+			hp_ticker = 0;
+		}
+	}
+
+	// MP regen
+	if (mp_per_minute > 0 && mp < maxmp && cur_hp > 0) {
+		int period = max(1, (60 * FRAMES_PER_SEC)/mp_per_minute);
+		mp_ticker += ticks;
+		mp += mp_ticker / period;
+		mp_ticker %= period;
+		if (mp >= maxmp) {
+			mp = maxmp;
+			mp_ticker = 0;
+		}
+	}
+
+	// handle buff/debuff animations
+	shield_frame = (shield_frame + ticks) % 12;
+	vengeance_frame = (vengeance_frame + ticks * vengeance_stacks) % 24;
+}
+
 /**
  * Remove temporary buffs/debuffs
  */
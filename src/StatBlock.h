@@ -36,8 +36,12 @@ public:
 	
 	void load(string filename);
 	void takeDamage(int dmg);
+	void takeDamage(int dmg, int &cur_hp);
 	void recalc();
 	void logic();
+	void logic(int &cur_hp, int &cur_cooldown);
+	void skipTicks(int ticks);
+	void skipTicks(int ticks, int &cur_hp, int &cur_cooldown);
 	void clearEffects();
 	Renderable getEffectRender(int effect_type);
 
@@ -166,9 +170,9 @@ public:
 	bool death_penalty;
 	
 	// Campaign event interaction
-	string defeat_status;
-	string quest_loot_requires;
-	string quest_loot_not;
+	int defeat_status; // campaign status atoms
+	int quest_loot_requires;
+	int quest_loot_not;
 	int quest_loot_id;
 	int first_defeat_loot;
 	
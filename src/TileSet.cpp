@@ -32,9 +32,7 @@ void TileSet::loadGraphics(string filename) {
 	SDL_SetColorKey( sprites, SDL_SRCCOLORKEY, SDL_MapRGB(sprites->format, 255, 0, 255) ); 
 	
 	// optimize
-	SDL_Surface *cleanup = sprites;
-	sprites = SDL_DisplayFormatAlpha(sprites);
-	SDL_FreeSurface(cleanup);	
+	sprites = optimizeSurface(sprites);
 }
 
 void TileSet::load(string filename) {
@@ -1,4 +1,5 @@
 #include "Utils.h"
+#include <map>
 using namespace std;
 
 int round(float f) {
@@ -82,9 +83,40 @@ double calcDist(Point p1, Point p2) {
 
 /**
  * is target within the area defined by center and radius?
+ * Compares squared distances; same result as calcDist() < radius
  */
 bool isWithin(Point center, int radius, Point target) {
-	return (calcDist(center, target) < radius);
+	if (radius <= 0) return false;
+	int x = target.x - center.x;
+	int y = target.y - center.y;
+	return x*x + y*y < radius*radius;
+}
+
+/**
+ * does a circle of this radius touch target anywhere on its way from one point to another?
+ * Same result as the single point test when from == to.
+ *
+ * @param t set to where along the way the circle comes closest, 0 at from and 1 at to
+ */
+bool isWithin(Point from, Point to, int radius, Point target, float &t) {
+	t = 0;
+	if (from.x == to.x && from.y == to.y) return isWithin(from, radius, target);
+	if (radius <= 0) return false;
+	
+	float dx = (float)(to.x - from.x);
+	float dy = (float)(to.y - from.y);
+	float px = (float)(target.x - from.x);
+	float py = (float)(target.y - from.y);
+	float len2 = dx*dx + dy*dy;
+	if (len2 > 0) {
+		t = (px*dx + py*dy) / len2;
+		if (t < 0) t = 0;
+		else if (t > 1) t = 1;
+	}
+	
+	float x = px - dx*t;
+	float y = py - dy*t;
+	return x*x + y*y < (float)(radius*radius);
 }
 
 /**
@@ -198,3 +230,169 @@ void drawPixel(SDL_Surface *screen, int x, int y, Uint32 color) {
 	*pixmem32 = color;
 }
 
+
+/**
+ * read a raw pixel value from a locked surface of any depth
+ */
+Uint32 readPixel(SDL_Surface *surface, int x, int y) {
+	int bpp = surface->format->BytesPerPixel;
+	Uint8 *p = (Uint8*)surface->pixels + y * surface->pitch + x * bpp;
+
+	switch (bpp) {
+		case 1:
+			return *p;
+		case 2:
+			return *(Uint16*)p;
+		case 3:
+			if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
+				return p[0] << 16 | p[1] << 8 | p[2];
+			else
+				return p[0] | p[1] << 8 | p[2] << 16;
+		case 4:
+			return *(Uint32*)p;
+	}
+	return 0;
+}
+
+/**
+ * Store a 0/255 alpha image as an 8-bit paletted surface.
+ * Palette entry 0 is the transparent colorkey; SDL expands the palette
+ * while blitting to the screen.
+ *
+ * @return NULL if the image has more than 255 opaque colours
+ */
+SDL_Surface* paletteSurface(SDL_Surface *surface) {
+	SDL_PixelFormat *fmt = surface->format;
+	map<Uint32, Uint8> index;
+	SDL_Color colors[256];
+	int color_count = 1;
+	Uint8 r,g,b;
+
+	colors[0].r = 255;
+	colors[0].g = 0;
+	colors[0].b = 255;
+
+	SDL_Surface *paletted = SDL_CreateRGBSurface(SDL_SWSURFACE, surface->w, surface->h, 8, 0, 0, 0, 0);
+	if (paletted == NULL) return NULL;
+
+	for (int y=0; y<surface->h; y++) {
+		Uint8 *dest = (Uint8*)paletted->pixels + y * paletted->pitch;
+		for (int x=0; x<surface->w; x++) {
+			Uint32 pixel = readPixel(surface, x, y);
+			if ((pixel & fmt->Amask) == 0) {
+				dest[x] = 0;
+				continue;
+			}
+
+			pixel &= ~fmt->Amask;
+			map<Uint32, Uint8>::iterator it = index.find(pixel);
+			if (it != index.end()) {
+				dest[x] = it->second;
+				continue;
+			}
+
+			// too many colours for a lossless palette
+			if (color_count == 256) {
+				SDL_FreeSurface(paletted);
+				return NULL;
+			}
+			SDL_GetRGB(pixel, fmt, &r, &g, &b);
+			colors[color_count].r = r;
+			colors[color_count].g = g;
+			colors[color_count].b = b;
+			index[pixel] = color_count;
+			dest[x] = color_count++;
+		}
+	}
+
+	SDL_SetColors(paletted, colors, 0, color_count);
+	SDL_SetColorKey(paletted, SDL_SRCCOLORKEY, 0);
+	return paletted;
+}
+
+/**
+ * Convert a freshly loaded image for fast blitting.
+ *
+ * Sprites whose alpha is strictly 0 or 255 don't need per-pixel blending:
+ * they become display-format surfaces with a magenta colorkey and RLE
+ * acceleration, or 8-bit paletted surfaces when PALETTED_SPRITES is set.
+ * Anything with partial transparency keeps its alpha channel.
+ * The colorkey should already be set on the input, which is freed.
+ */
+SDL_Surface* optimizeSurface(SDL_Surface *surface) {
+	if (surface == NULL) return NULL;
+
+	SDL_Surface *cleanup = surface;
+	surface = SDL_DisplayFormatAlpha(surface);
+	SDL_FreeSurface(cleanup);
+	if (surface == NULL) return NULL;
+
+	SDL_PixelFormat *fmt = surface->format;
+	SDL_PixelFormat *display = SDL_GetVideoSurface()->format;
+	Uint32 display_key = SDL_MapRGB(display, 255, 0, 255);
+	Uint32 clear = SDL_MapRGBA(fmt, 255, 0, 255, 0);
+	bool binary = true;
+	bool transparent = false;
+	Uint8 r,g,b;
+
+	// classify the alpha channel
+	if (SDL_MUSTLOCK(surface)) SDL_LockSurface(surface);
+	for (int y=0; y<surface->h && binary; y++) {
+		for (int x=0; x<surface->w; x++) {
+			Uint32 pixel = readPixel(surface, x, y);
+			Uint32 alpha = pixel & fmt->Amask;
+			if (alpha == 0) {
+				transparent = true;
+			}
+			else if (alpha != fmt->Amask) {
+				binary = false;
+				break;
+			}
+			else {
+				// an opaque pixel that would turn into the colorkey can't be keyed
+				SDL_GetRGB(pixel, fmt, &r, &g, &b);
+				if (SDL_MapRGB(display, r, g, b) == display_key) {
+					binary = false;
+					break;
+				}
+			}
+		}
+	}
+
+	// paint every transparent pixel with the key colour
+	if (binary && transparent) {
+		for (int y=0; y<surface->h; y++) {
+			for (int x=0; x<surface->w; x++) {
+				Uint32 *p = (Uint32*)((Uint8*)surface->pixels + y * surface->pitch) + x;
+				if ((*p & fmt->Amask) == 0) *p = clear;
+			}
+		}
+	}
+	if (SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+
+	if (!binary) return surface;
+
+	// optionally trade blit speed for a quarter of the memory
+	if (PALETTED_SPRITES) {
+		if (SDL_MUSTLOCK(surface)) SDL_LockSurface(surface);
+		SDL_Surface *paletted = paletteSurface(surface);
+		if (SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+		if (paletted) {
+			SDL_FreeSurface(surface);
+			return paletted;
+		}
+	}
+
+	// drop the alpha channel
+	SDL_SetAlpha(surface, 0, 255);
+	SDL_Surface *keyed = SDL_DisplayFormat(surface);
+	if (keyed == NULL) {
+		SDL_SetAlpha(surface, SDL_SRCALPHA, 255);
+		return surface;
+	}
+	SDL_FreeSurface(surface);
+
+	if (transparent)
+		SDL_SetColorKey(keyed, SDL_SRCCOLORKEY | SDL_RLEACCEL, SDL_MapRGB(keyed->format, 255, 0, 255));
+	return keyed;
+}
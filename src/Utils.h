@@ -15,6 +15,7 @@
 #include "SDL_image.h"
 #include "math.h"
 #include "Settings.h"
+#include "Atom.h"
 
 using namespace std;
 
@@ -37,14 +38,15 @@ struct Renderable {
 };
 
 struct Event_Component {
-	string type;
+	int type; // atom
 	string s;
 	int x;
 	int y;
 	int z;
 	
 	Event_Component() {
-		type = s = "";
+		type = ATOM_NONE;
+		s = "";
 		x = y = z = 0;
 	}
 };
@@ -58,9 +60,13 @@ FPoint calcVector(Point pos, int direction, int dist);
 double calcDist(Point p1, Point p2);
 bool isWithin(Point center, int radius, Point target);
 bool isWithin(SDL_Rect r, Point target);
+bool isWithin(Point from, Point to, int radius, Point target, float &t);
 void zsort(Renderable r[], int rnum);
 void sort_by_tile(Renderable r[], int rnum);
 void drawPixel(SDL_Surface *screen, int x, int y, Uint32 color);
+Uint32 readPixel(SDL_Surface *surface, int x, int y);
+SDL_Surface* paletteSurface(SDL_Surface *surface);
+SDL_Surface* optimizeSurface(SDL_Surface *surface);
 
 /**
  * As implemented here:
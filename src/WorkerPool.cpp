@@ -0,0 +1,101 @@
+/**
+ * class WorkerPool
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool() {
+	helper_count = 0;
+	quit = false;
+	done = NULL;
+	job = NULL;
+	job_data = NULL;
+}
+
+/**
+ * Start the helper threads.
+ * thread_count includes the calling thread; 1 runs everything on the caller.
+ */
+void WorkerPool::init(int thread_count) {
+	shutdown();
+	
+	if (thread_count > MAX_WORKERS) thread_count = MAX_WORKERS;
+	if (thread_count <= 1) return;
+	
+	done = SDL_CreateSemaphore(0);
+	for (int i=0; i<thread_count-1; i++) {
+		slots[i].pool = this;
+		slots[i].index = i;
+		start[i] = SDL_CreateSemaphore(0);
+		threads[i] = SDL_CreateThread(threadMain, &slots[i]);
+		if (threads[i] == NULL) {
+			fprintf(stderr, "Couldn't start worker thread: %s\n", SDL_GetError());
+			SDL_DestroySemaphore(start[i]);
+			break;
+		}
+		helper_count++;
+	}
+}
+
+int WorkerPool::threadMain(void *data) {
+	Worker_Slot *slot = (Worker_Slot*)data;
+	WorkerPool *pool = slot->pool;
+	
+	while (true) {
+		SDL_SemWait(pool->start[slot->index]);
+		if (pool->quit) break;
+		if (slot->begin < slot->end)
+			pool->job(pool->job_data, slot->begin, slot->end);
+		SDL_SemPost(pool->done);
+	}
+	return 0;
+}
+
+/**
+ * Call _job on every part of [0, count) and wait for all of them.
+ * The caller always does the first part.
+ */
+void WorkerPool::run(Worker_Job _job, void *data, int count) {
+	int parts = helper_count + 1;
+	if (count / WORKER_MIN_BATCH < parts) parts = count / WORKER_MIN_BATCH;
+	if (parts <= 1) {
+		if (count > 0) _job(data, 0, count);
+		return;
+	}
+	
+	job = _job;
+	job_data = data;
+	for (int i=1; i<parts; i++) {
+		slots[i-1].begin = count * i / parts;
+		slots[i-1].end = count * (i+1) / parts;
+		SDL_SemPost(start[i-1]);
+	}
+	
+	_job(data, 0, count / parts);
+	
+	for (int i=1; i<parts; i++) {
+		SDL_SemWait(done);
+	}
+}
+
+void WorkerPool::shutdown() {
+	quit = true;
+	for (int i=0; i<helper_count; i++) {
+		SDL_SemPost(start[i]);
+	}
+	for (int i=0; i<helper_count; i++) {
+		SDL_WaitThread(threads[i], NULL);
+		SDL_DestroySemaphore(start[i]);
+	}
+	if (done != NULL) SDL_DestroySemaphore(done);
+	done = NULL;
+	helper_count = 0;
+	quit = false;
+}
+
+WorkerPool::~WorkerPool() {
+	shutdown();
+}
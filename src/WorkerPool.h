@@ -0,0 +1,59 @@
+/**
+ * class WorkerPool
+ *
+ * A few helper threads that split a range of work items with the caller.
+ *
+ * run() cuts [0, count) into contiguous parts, hands one part to each
+ * thread, does the first part itself and returns when all parts are done.
+ * Jobs must only write to state owned by their own items.
+ *
+ * @author agent
+ * @license GPL
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdio.h>
+#include "SDL.h"
+#include "SDL_thread.h"
+
+const int MAX_WORKERS = 16;
+
+// don't wake a thread for fewer items than this
+const int WORKER_MIN_BATCH = 8;
+
+typedef void (*Worker_Job)(void *data, int begin, int end);
+
+class WorkerPool;
+
+struct Worker_Slot {
+	WorkerPool *pool;
+	int index;
+	int begin;
+	int end;
+};
+
+class WorkerPool {
+private:
+	SDL_Thread *threads[MAX_WORKERS];
+	SDL_sem *start[MAX_WORKERS];
+	Worker_Slot slots[MAX_WORKERS];
+	SDL_sem *done;
+	int helper_count; // threads besides the caller
+	bool quit;
+
+	Worker_Job job;
+	void *job_data;
+
+	static int threadMain(void *data);
+	void shutdown();
+
+public:
+	WorkerPool();
+	~WorkerPool();
+	void init(int thread_count);
+	void run(Worker_Job _job, void *data, int count);
+};
+
+#endif
@@ -17,6 +17,7 @@ using namespace std;
 #include "Settings.h"
 #include "InputState.h"
 #include "GameSwitcher.h"
+#include "AnimationSet.h"
 
 SDL_Surface *screen;
 InputState *inps;
@@ -121,6 +122,7 @@ int main(int argc, char *argv[])
 	// TODO: halt all sounds here before freeing music/chunks
 	delete gswitch;
 	delete inps;
+	AnimationSet::clearCache();
 	SDL_FreeSurface(screen);
 	Mix_CloseAudio();
 	SDL_Quit();